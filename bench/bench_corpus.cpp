@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////////
+// bench/bench_corpus.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "bench_corpus.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <set>
+
+BenchCorpus generateCorpus(size_t messageCount, size_t symbolCount, uint64_t seed) {
+    BenchCorpus corpus;
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> typeDist(0, 99);
+    std::uniform_int_distribution<int> qtyDist(1, 1000);
+    std::uniform_int_distribution<int> sideDist(0, 1);
+    std::uniform_int_distribution<int> brokerDist(0, 3);
+    std::normal_distribution<double> stepDist(0.0, 0.05);
+
+    std::vector<double> mids;
+    for(size_t i = 0; i < symbolCount; ++i) {
+        char name[24];
+        std::snprintf(name, sizeof(name), "SYM%03zu", i);
+        corpus.symbols.push_back(name);
+        mids.push_back(100.0 + 10.0 * static_cast<double>(i));
+    }
+    std::uniform_int_distribution<size_t> symDist(0, symbolCount - 1);
+
+    static const char* sides[] = {"buy", "sell"};
+    static const char* brokers[] = {"BrokerA", "BrokerB", "BrokerC", "BrokerD"};
+    long long tm = 1700000000000LL;
+
+    corpus.messages.reserve(messageCount);
+    char line[512];
+    for(size_t n = 0; n < messageCount; ++n) {
+        size_t sym = symDist(rng);
+        mids[sym] = std::max(1.0, mids[sym] + stepDist(rng));
+        double price = std::round(mids[sym] * 100.0) / 100.0;
+        tm += 1;
+
+        // Mix roughly matching a live feed: adds, cancels, fills, replaces
+        int t = typeDist(rng);
+        const char* type = t < 40 ? "oba" : t < 65 ? "obc" : t < 85 ? "obf" : "obr";
+        int len;
+        if(type[2] == 'r') {
+            len = std::snprintf(line, sizeof(line),
+                "{\"type\":\"%s\",\"s\":\"%s\",\"tm\":%lld,\"q\":%d,\"p\":%.2f,\"x\":\"%s\","
+                "\"id\":\"ID%zu\",\"a\":\"%s\",\"mid\":\"MID%zu\",\"nid\":\"NID%zu\"}",
+                type, corpus.symbols[sym].c_str(), tm, qtyDist(rng), price, sides[sideDist(rng)],
+                n, brokers[brokerDist(rng)], n, n);
+        } else {
+            len = std::snprintf(line, sizeof(line),
+                "{\"type\":\"%s\",\"s\":\"%s\",\"tm\":%lld,\"q\":%d,\"p\":%.2f,\"x\":\"%s\","
+                "\"id\":\"ID%zu\",\"a\":\"%s\",\"mid\":\"MID%zu\"}",
+                type, corpus.symbols[sym].c_str(), tm, qtyDist(rng), price, sides[sideDist(rng)],
+                n, brokers[brokerDist(rng)], n);
+        }
+        corpus.messages.emplace_back(line, static_cast<size_t>(len));
+        corpus.ndjson.append(line, static_cast<size_t>(len));
+        corpus.ndjson += '\n';
+    }
+    return corpus;
+}
+
+bool loadCorpus(const std::string &path, BenchCorpus &corpus) {
+    std::ifstream in(path);
+    if(!in.is_open()) return false;
+
+    std::set<std::string> symbols;
+    std::string line;
+    while(std::getline(in, line)) {
+        if(line.empty() || line[0] != '{') continue;
+        // Collect symbols with a cheap scan for "s":"..."
+        auto pos = line.find("\"s\":\"");
+        if(pos != std::string::npos) {
+            auto end = line.find('"', pos + 5);
+            if(end != std::string::npos) symbols.insert(line.substr(pos + 5, end - pos - 5));
+        }
+        corpus.ndjson += line;
+        corpus.ndjson += '\n';
+        corpus.messages.push_back(std::move(line));
+    }
+    corpus.symbols.assign(symbols.begin(), symbols.end());
+    return !corpus.messages.empty();
+}
@@ -0,0 +1,28 @@
+////////////////////////////////////////////////////////////////////////////////
+// bench/bench_corpus.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef BENCH_CORPUS_HPP
+#define BENCH_CORPUS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Input for the benchmarks: one MBO message per entry plus the same
+ * messages joined as NDJSON, either generated from a fixed seed or
+ * loaded from a capture (e.g. data_gen output).
+ */
+struct BenchCorpus {
+    std::vector<std::string> messages;
+    std::string ndjson;
+    std::vector<std::string> symbols;
+};
+
+// Deterministic synthetic corpus: identical for identical arguments
+BenchCorpus generateCorpus(size_t messageCount, size_t symbolCount, uint64_t seed);
+
+// Loads one JSON object per line; false if the file cannot be read or is empty
+bool loadCorpus(const std::string &path, BenchCorpus &corpus);
+
+#endif // BENCH_CORPUS_HPP
@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////
+// bench/bench_harness.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Keeps the compiler from discarding a computed value
+template <typename T>
+inline void doNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations = 0;  // operations per repetition
+    double nsPerOp = 0.0;     // median over repetitions
+    double minNsPerOp = 0.0;
+    double maxNsPerOp = 0.0;
+    double itemsPerOp = 1.0;  // e.g. messages handled by one operation
+    double bytesPerOp = 0.0;
+};
+
+/*
+ * Minimal fixed-time benchmark runner. The body is called as
+ * body(iterations) and must perform that many operations; the iteration
+ * count is grown until one repetition takes at least minTime.
+ */
+class BenchRunner {
+public:
+    BenchRunner(std::string filter, double minTimeSeconds, int repetitions)
+        : nameFilter(std::move(filter)), minTime(minTimeSeconds), reps(repetitions) {}
+
+    // True if name passes the --filter substring
+    bool selected(const std::string &name) const {
+        return nameFilter.empty() || name.find(nameFilter) != std::string::npos;
+    }
+
+    template <typename Body>
+    void run(const std::string &name, double itemsPerOp, double bytesPerOp, Body &&body) {
+        if(!selected(name)) return;
+
+        uint64_t iterations = 1;
+        while(true) {
+            double seconds = timeOnce(body, iterations);
+            if(seconds >= minTime || iterations >= (1ull << 40)) break;
+            double scale = seconds > 0.0 ? (minTime * 1.2) / seconds : 100.0;
+            iterations = static_cast<uint64_t>(iterations * std::clamp(scale, 1.5, 100.0));
+        }
+
+        std::vector<double> samples;
+        for(int r = 0; r < reps; ++r) {
+            samples.push_back(timeOnce(body, iterations) * 1e9 / static_cast<double>(iterations));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult res;
+        res.name = name;
+        res.iterations = iterations;
+        res.nsPerOp = samples[samples.size() / 2];
+        res.minNsPerOp = samples.front();
+        res.maxNsPerOp = samples.back();
+        res.itemsPerOp = itemsPerOp;
+        res.bytesPerOp = bytesPerOp;
+        results.push_back(res);
+
+        std::cout << std::left << std::setw(36) << name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(1) << res.nsPerOp << " ns/op"
+                  << std::setw(14) << std::setprecision(2) << itemsPerSecond(res) / 1e6 << " M items/s";
+        if(bytesPerOp > 0.0) {
+            std::cout << std::setw(10) << std::setprecision(3)
+                      << bytesPerOp / res.nsPerOp << " GB/s";
+        }
+        std::cout << std::endl;
+    }
+
+    static double itemsPerSecond(const BenchResult &r) {
+        return r.nsPerOp > 0.0 ? r.itemsPerOp * 1e9 / r.nsPerOp : 0.0;
+    }
+
+    // Writes {"context": {...}, "benchmarks": [...]}; context values are pre-rendered JSON
+    bool writeJson(const std::string &path,
+                   const std::vector<std::pair<std::string, std::string>> &context) const {
+        std::ofstream out(path);
+        if(!out.is_open()) return false;
+        out << "{\n  \"context\": {";
+        for(size_t i = 0; i < context.size(); ++i) {
+            out << (i ? "," : "") << "\n    \"" << context[i].first << "\": " << context[i].second;
+        }
+        out << "\n  },\n  \"benchmarks\": [";
+        out << std::setprecision(6) << std::defaultfloat;
+        for(size_t i = 0; i < results.size(); ++i) {
+            const BenchResult &r = results[i];
+            out << (i ? "," : "") << "\n    {\"name\": \"" << r.name << "\""
+                << ", \"iterations\": " << r.iterations
+                << ", \"repetitions\": " << reps
+                << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"min_ns_per_op\": " << r.minNsPerOp
+                << ", \"max_ns_per_op\": " << r.maxNsPerOp
+                << ", \"items_per_op\": " << r.itemsPerOp
+                << ", \"items_per_second\": " << itemsPerSecond(r)
+                << ", \"bytes_per_second\": " << (r.nsPerOp > 0.0 ? r.bytesPerOp * 1e9 / r.nsPerOp : 0.0)
+                << "}";
+        }
+        out << "\n  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    template <typename Body>
+    static double timeOnce(Body &body, uint64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    std::string nameFilter;
+    double minTime;
+    int reps;
+    std::vector<BenchResult> results;
+};
+
+#endif // BENCH_HARNESS_HPP
@@ -0,0 +1,620 @@
+////////////////////////////////////////////////////////////////////////////////
+// bench/hf_bench.cpp
+////////////////////////////////////////////////////////////////////////////////
+// Microbenchmarks for the ingest pipeline plus an end-to-end DevMonitor run.
+//
+//   hf_bench [--json out.json] [--filter name] [--corpus file.ndjson]
+//            [--messages N] [--symbols N] [--seed N] [--min-time sec] [--reps N]
+////////////////////////////////////////////////////////////////////////////////
+#include "bench_harness.hpp"
+#include "bench_corpus.hpp"
+
+#include "bar_aggregator.hpp"
+#include "bounded_queue.hpp"
+#include "core_data.hpp"
+#include "data_processor.hpp"
+#include "dev_monitor.hpp"
+#include "influx_db_client.hpp"
+#include "mbo_block_decoder.hpp"
+#include "mbo_message.hpp"
+#include "message_framer.hpp"
+#include "numeric_parse.hpp"
+#include "order_book.hpp"
+#include "series_decimation.hpp"
+#include "structural_index.hpp"
+#include "symbol_filter.hpp"
+#include "ticker_conflator.hpp"
+#include "wait_strategy.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <time.h>
+
+struct BenchOptions {
+    std::string jsonPath;
+    std::string filter;
+    std::string corpusPath;
+    size_t messages = 100000;
+    size_t symbols = 16;
+    uint64_t seed = 42;
+    double minTime = 0.5;
+    int reps = 5;
+};
+
+static bool parseArgs(int argc, char* argv[], BenchOptions &opts) {
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            return i + 1 < argc ? argv[++i] : "";
+        };
+        if(arg == "--json") opts.jsonPath = value();
+        else if(arg == "--filter") opts.filter = value();
+        else if(arg == "--corpus") opts.corpusPath = value();
+        else if(arg == "--messages") opts.messages = std::stoull(value());
+        else if(arg == "--symbols") opts.symbols = std::stoull(value());
+        else if(arg == "--seed") opts.seed = std::stoull(value());
+        else if(arg == "--min-time") opts.minTime = std::stod(value());
+        else if(arg == "--reps") opts.reps = std::stoi(value());
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    if(opts.symbols == 0) {
+        std::cerr << "--symbols must be at least 1" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Fresh pipeline state whose mock DB output goes to /dev/null
+struct BenchPipeline {
+    CoreData app;
+    std::ofstream sink{"/dev/null"};
+    std::shared_ptr<InfluxDBClient> db;
+    std::shared_ptr<DataProcessor> processor;
+
+    BenchPipeline() {
+        db = std::make_shared<InfluxDBClient>("http://localhost:8086", "bench");
+        db->setOutput(&sink);
+        processor = std::make_shared<DataProcessor>(db, &app);
+    }
+};
+
+static void benchParse(BenchRunner &runner, const BenchCorpus &corpus) {
+    const auto &msgs = corpus.messages;
+    double avgBytes = static_cast<double>(corpus.ndjson.size()) / msgs.size();
+    runner.run("parse/mbo_message", 1, avgBytes, [&](uint64_t n) {
+        MboMessage msg;
+        std::string error;
+        for(uint64_t i = 0; i < n; ++i) {
+            bool ok = parseMboMessage(msgs[i % msgs.size()], msg, error);
+            doNotOptimize(ok);
+        }
+    });
+}
+
+static void benchStructuralIndex(BenchRunner &runner, const BenchCorpus &corpus) {
+    // One operation indexes the whole corpus as a single block
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2};
+    std::vector<uint32_t> index;
+    for(SimdLevel level : levels) {
+        if(static_cast<int>(level) > static_cast<int>(detectSimdLevel())) continue;
+        runner.run(std::string("scan/structural_index_") + simdLevelName(level), 1,
+                   static_cast<double>(corpus.ndjson.size()), [&](uint64_t n) {
+            for(uint64_t i = 0; i < n; ++i) {
+                buildStructuralIndex(corpus.ndjson.data(), corpus.ndjson.size(), index, level);
+                doNotOptimize(index.data());
+            }
+        });
+    }
+
+    MboBlockDecoder decoder;
+    runner.run("parse/mbo_block_decoder", static_cast<double>(corpus.messages.size()),
+               static_cast<double>(corpus.ndjson.size()), [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            doNotOptimize(decoder.decode(corpus.ndjson.data(), corpus.ndjson.size()));
+        }
+    });
+}
+
+// Raw text of one numeric member from the first messages of the corpus
+static std::vector<std::string> fieldTexts(const BenchCorpus &corpus, const std::string &key) {
+    std::vector<std::string> out;
+    const std::string pattern = "\"" + key + "\":";
+    for(const auto &m : corpus.messages) {
+        size_t pos = m.find(pattern);
+        if(pos == std::string::npos) continue;
+        pos += pattern.size();
+        out.push_back(m.substr(pos, m.find_first_of(",}", pos) - pos));
+        if(out.size() == 4096) break;
+    }
+    return out;
+}
+
+static void benchNumericFields(BenchRunner &runner, const BenchCorpus &corpus) {
+    std::vector<std::string> tm = fieldTexts(corpus, "tm");
+    std::vector<std::string> q = fieldTexts(corpus, "q");
+    std::vector<std::string> p = fieldTexts(corpus, "p");
+    if(tm.empty() || q.empty() || p.empty()) return;
+
+    // One operation decodes one field
+    auto run = [&](const char* name, const std::vector<std::string> &texts, auto &&parse) {
+        runner.run(name, 1, 0, [&](uint64_t n) {
+            for(uint64_t i = 0; i < n; ++i) {
+                const std::string &t = texts[i % texts.size()];
+                parse(t.data(), t.data() + t.size());
+            }
+        });
+    };
+    run("field/tm_swar", tm, [](const char* b, const char* e) {
+        long long v = 0;
+        doNotOptimize(parseJsonInt64(b, e, v));
+        doNotOptimize(v);
+    });
+    run("field/tm_from_chars", tm, [](const char* b, const char* e) {
+        long long v = 0;
+        doNotOptimize(std::from_chars(b, e, v).ptr);
+        doNotOptimize(v);
+    });
+    run("field/q_swar", q, [](const char* b, const char* e) {
+        int v = 0;
+        doNotOptimize(parseJsonInt32(b, e, v));
+        doNotOptimize(v);
+    });
+    run("field/q_from_chars", q, [](const char* b, const char* e) {
+        int v = 0;
+        doNotOptimize(std::from_chars(b, e, v).ptr);
+        doNotOptimize(v);
+    });
+    run("field/p_fixed_point", p, [](const char* b, const char* e) {
+        double v = 0;
+        long long ticks = 0;
+        doNotOptimize(parseJsonPrice(b, e, v, ticks));
+        doNotOptimize(v);
+        doNotOptimize(ticks);
+    });
+    run("field/p_from_chars", p, [](const char* b, const char* e) {
+        double v = 0;
+        doNotOptimize(std::from_chars(b, e, v).ptr);
+        doNotOptimize(v);
+    });
+}
+
+static void benchTypeDispatch(BenchRunner &runner, const BenchCorpus &corpus) {
+    std::vector<std::string> tags = fieldTexts(corpus, "type");
+    if(tags.empty()) return;
+    for(auto &t : tags) t = t.substr(1, t.size() - 2); // strip the quotes
+    runner.run("dispatch/type_from_tag", 1, 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            const std::string &t = tags[i % tags.size()];
+            doNotOptimize(mboTypeFromTag(t.data(), t.size()));
+        }
+    });
+}
+
+static void benchSymbolFilter(BenchRunner &runner, const BenchCorpus &corpus) {
+    if(corpus.symbols.empty()) return;
+    // Every other symbol subscribed
+    SymbolFilter filter;
+    std::vector<std::string> subscribed;
+    for(size_t i = 0; i < corpus.symbols.size(); i += 2) subscribed.push_back(corpus.symbols[i]);
+    filter.assign(subscribed);
+    filter.setEnabled(true);
+
+    const auto &msgs = corpus.messages;
+    runner.run("filter/scan_and_lookup", static_cast<double>(msgs.size()),
+               static_cast<double>(corpus.ndjson.size()), [&](uint64_t n) {
+        size_t admitted = 0;
+        for(uint64_t it = 0; it < n; ++it) {
+            for(const auto &m : msgs) {
+                const char* symbol;
+                size_t length;
+                admitted += scanSymbolField(m.data(), m.size(), symbol, length) && filter.contains(symbol, length);
+            }
+        }
+        doNotOptimize(admitted);
+    });
+
+    // DevMonitor on stdin with the same half of the symbols subscribed
+    runner.run("filter/dev_monitor_e2e", static_cast<double>(msgs.size()),
+               static_cast<double>(corpus.ndjson.size()), [&](uint64_t n) {
+        for(uint64_t it = 0; it < n; ++it) {
+            BenchPipeline pipe;
+            pipe.app.symbolFilter.assign(subscribed);
+            pipe.app.symbolFilter.setEnabled(true);
+            std::istringstream input(corpus.ndjson);
+            DevMonitor mon(pipe.processor, input);
+            std::atomic<bool> stop{false};
+            std::atomic<int> requests{0};
+            mon.run(stop, requests);
+            doNotOptimize(requests.load());
+        }
+    });
+}
+
+static const WaitMode ALL_WAIT_MODES[] = {WaitMode::Spin, WaitMode::SpinYield, WaitMode::Park, WaitMode::Adaptive};
+
+static uint64_t steadyNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static double threadCpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+/*
+ * Wakeup cost of each wait strategy: a ping-pong round trip between two
+ * threads, then CPU use and wakeup latency of a waiter fed 1000 wakeups/s.
+ */
+static void benchWaitStrategies(BenchRunner &runner) {
+    for(WaitMode mode : ALL_WAIT_MODES) {
+        std::string name = std::string("wait/") + waitModeName(mode);
+        runner.run(name + "_pingpong", 1, 0, [&](uint64_t n) {
+            WaitStrategy ping(mode), pong(mode);
+            std::atomic<uint64_t> request{0}, reply{0};
+            std::thread echo([&] {
+                for(uint64_t i = 1; i <= n; ++i) {
+                    while(!ping.waitUntil([&] { return request.load(std::memory_order_acquire) >= i; },
+                                          std::chrono::seconds(1))) {}
+                    reply.store(i, std::memory_order_release);
+                    pong.notify();
+                }
+            });
+            for(uint64_t i = 1; i <= n; ++i) {
+                request.store(i, std::memory_order_release);
+                ping.notify();
+                while(!pong.waitUntil([&] { return reply.load(std::memory_order_acquire) >= i; },
+                                      std::chrono::seconds(1))) {}
+            }
+            echo.join();
+        });
+
+        if(!runner.selected(name + "_idle")) continue;
+        const int wakeups = 300;
+        WaitStrategy wait(mode);
+        std::atomic<uint64_t> sent{0}, stampNs{0};
+        std::vector<double> latencyUs;
+        double cpuSeconds = 0.0;
+        auto wallStart = std::chrono::steady_clock::now();
+        std::thread waiter([&] {
+            double cpuStart = threadCpuSeconds();
+            for(uint64_t i = 1; i <= static_cast<uint64_t>(wakeups); ++i) {
+                while(!wait.waitUntil([&] { return sent.load(std::memory_order_acquire) >= i; },
+                                      std::chrono::seconds(1))) {}
+                latencyUs.push_back((steadyNs() - stampNs.load(std::memory_order_acquire)) / 1e3);
+            }
+            cpuSeconds = threadCpuSeconds() - cpuStart;
+        });
+        for(int i = 1; i <= wakeups; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            stampNs.store(steadyNs(), std::memory_order_release);
+            sent.store(static_cast<uint64_t>(i), std::memory_order_release);
+            wait.notify();
+        }
+        waiter.join();
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        std::sort(latencyUs.begin(), latencyUs.end());
+        std::cout << std::left << std::setw(36) << name + "_idle" << std::right << std::fixed
+                  << std::setw(8) << std::setprecision(1) << 100.0 * cpuSeconds / wall << " % cpu"
+                  << std::setw(10) << std::setprecision(1) << latencyUs[latencyUs.size() / 2] << " us p50"
+                  << std::setw(10) << latencyUs[latencyUs.size() * 99 / 100] << " us p99"
+                  << "  (" << wakeups << " wakeups at 1/ms)" << std::endl;
+    }
+}
+
+// Push cost of each overflow policy with pops at half the push rate (conflate keeps one entry per symbol)
+static void benchBoundedQueue(BenchRunner &runner, const BenchCorpus &corpus) {
+    const auto &msgs = corpus.messages;
+    auto symbolKey = [](const std::string &raw) {
+        const char* symbol;
+        size_t length;
+        return scanSymbolField(raw.data(), raw.size(), symbol, length) ? std::string(symbol, length) : std::string();
+    };
+    for(OverflowPolicy policy : {OverflowPolicy::DropOldest, OverflowPolicy::DropNewest, OverflowPolicy::Conflate}) {
+        runner.run(std::string("queue/full_push_") + overflowPolicyName(policy), 1, 0, [&](uint64_t n) {
+            BoundedQueue<std::string> queue(1024, policy, WaitMode::Park, symbolKey);
+            std::string out;
+            for(uint64_t i = 0; i < n; ++i) {
+                queue.push(msgs[i % msgs.size()]);
+                if(i % 2 == 1) queue.pop(out, std::chrono::nanoseconds(0));
+            }
+            doNotOptimize(queue.dropped.load());
+        });
+    }
+}
+
+static void benchFraming(BenchRunner &runner, const BenchCorpus &corpus) {
+    // One operation frames the whole corpus fed in 4 KiB reads
+    const size_t chunk = 4096;
+    runner.run("frame/message_framer", static_cast<double>(corpus.messages.size()),
+               static_cast<double>(corpus.ndjson.size()), [&](uint64_t n) {
+        std::string piece;
+        std::string message;
+        for(uint64_t it = 0; it < n; ++it) {
+            MessageFramer framer;
+            size_t framed = 0;
+            for(size_t off = 0; off < corpus.ndjson.size(); off += chunk) {
+                piece.assign(corpus.ndjson, off, chunk);
+                framer.append(piece);
+                while(framer.next(message)) {
+                    ++framed;
+                }
+            }
+            doNotOptimize(framed);
+        }
+    });
+}
+
+static void benchStats(BenchRunner &runner) {
+    BenchPipeline pipe;
+    const std::string stream = "DEV";
+    runner.run("stats/record_stream_message", 1, 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            pipe.processor->recordStreamMessage(stream);
+        }
+    });
+}
+
+static void benchTickerAppend(BenchRunner &runner, const BenchCorpus &corpus) {
+    std::map<std::string, TickerData> tickerMap;
+    const auto &syms = corpus.symbols;
+    runner.run("ticker/append", 1, 0, [&](uint64_t n) {
+        double price = 100.0;
+        for(uint64_t i = 0; i < n; ++i) {
+            tickerMap[syms[i % syms.size()]].append(static_cast<double>(i), price, 1000);
+            price += 0.01;
+        }
+    });
+}
+
+static void benchTickerConflation(BenchRunner &runner, const BenchCorpus &corpus) {
+    const auto &syms = corpus.symbols;
+    TickerConflator conflator;
+    runner.run("ticker/conflate_record", 1, 0, [&](uint64_t n) {
+        double price = 100.0;
+        for(uint64_t i = 0; i < n; ++i) {
+            conflator.record(syms[i % syms.size()], price);
+            price += 0.01;
+        }
+    });
+
+    // One UI frame: every symbol updated, drained into the graph history
+    std::map<std::string, TickerData> tickerMap;
+    runner.run("ticker/conflate_frame", static_cast<double>(syms.size()), 0, [&](uint64_t n) {
+        double price = 100.0;
+        for(uint64_t i = 0; i < n; ++i) {
+            for(const auto &sym : syms) conflator.record(sym, price);
+            conflator.drain([&](const std::string &symbol, const TickerInterval &interval) {
+                tickerMap[symbol].appendInterval(interval, static_cast<double>(i), 900);
+            });
+            price += 0.01;
+        }
+    });
+}
+
+// One fill folded into the 1s, 1m and 5m bars of its symbol, and one UI copy of a full series
+static void benchBars(BenchRunner &runner, const BenchCorpus &corpus) {
+    const auto &syms = corpus.symbols;
+    BarAggregator bars;
+    runner.run("bars/add_fill", 1, 0, [&](uint64_t n) {
+        double price = 100.0;
+        for(uint64_t i = 0; i < n; ++i) {
+            bars.add(syms[i % syms.size()], 1700000000000LL + static_cast<long long>(i), price, 10);
+            price += 0.01;
+        }
+    });
+
+    BarSeries series;
+    runner.run("bars/snapshot_1s", static_cast<double>(BAR_HISTORY), 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            series.version = 0; // Force the copy
+            bars.snapshot(syms[0], 1000, series);
+        }
+    });
+}
+
+// Order lifecycles on a book holding ~1000 orders per symbol: add, partial fill, cancel
+static void benchOrderBook(BenchRunner &runner, const BenchCorpus &corpus) {
+    const auto &syms = corpus.symbols;
+    std::vector<std::string> ids;
+    for(size_t i = 0; i < 1000 * syms.size(); ++i) ids.push_back("ID" + std::to_string(i));
+    OrderBook book;
+    for(size_t i = 0; i < ids.size(); ++i) {
+        book.add(syms[i % syms.size()], ids[i], (i & 1) != 0, (10000 + static_cast<long long>(i % 40)) * 1000000, 100);
+    }
+    runner.run("book/add_fill_cancel", 3, 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            size_t k = i % ids.size();
+            const std::string &sym = syms[k % syms.size()];
+            book.remove(sym, ids[k]);
+            book.add(sym, ids[k], (k & 1) != 0, (10000 + static_cast<long long>(i % 40)) * 1000000, 100);
+            book.fill(sym, ids[k], 30);
+        }
+    });
+
+    BookDepth depth;
+    runner.run("book/depth_20", 40, 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            depth.version = 0; // Force the copy
+            book.depth(syms[0], 20, depth);
+        }
+    });
+}
+
+static void benchDecimation(BenchRunner &runner, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.1);
+    std::vector<double> series(100000);
+    double v = 100.0;
+    for(auto &x : series) {
+        v += step(rng);
+        x = v;
+    }
+    std::vector<double> history(series.begin(), series.begin() + 1000);
+
+    std::vector<double> out;
+    runner.run("decimate/min_max_1k_to_300", 1000, 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            decimateMinMax(history, 300, out);
+            doNotOptimize(out.data());
+        }
+    });
+    runner.run("decimate/min_max_100k_to_1k", 100000, 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            decimateMinMax(series, 1000, out);
+            doNotOptimize(out.data());
+        }
+    });
+
+    // 100k samples 1 ms apart; a 10 s window (10k samples) and the whole series into 1k columns
+    std::vector<double> times(series.size());
+    for(size_t i = 0; i < times.size(); ++i) times[i] = i * 1e-3;
+    std::vector<std::pair<double, double>> window;
+    runner.run("decimate/window_10k_of_100k_to_1k", 10000, 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            decimateWindow(times, series, 45.0, 55.0, 1000, window);
+            doNotOptimize(window.data());
+        }
+    });
+    runner.run("decimate/window_100k_to_1k", 100000, 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            decimateWindow(times, series, 0.0, 100.0, 1000, window);
+            doNotOptimize(window.data());
+        }
+    });
+}
+
+static void benchLineProtocol(BenchRunner &runner, const BenchCorpus &corpus) {
+    std::vector<MboMessage> msgs;
+    for(size_t i = 0; i < corpus.messages.size() && i < 4096; ++i) {
+        MboMessage m;
+        std::string error;
+        if(parseMboMessage(corpus.messages[i], m, error)) msgs.push_back(std::move(m));
+    }
+    if(msgs.empty()) return;
+
+    std::string out;
+    runner.run("encode/line_protocol", 1, 0, [&](uint64_t n) {
+        for(uint64_t i = 0; i < n; ++i) {
+            const MboMessage &m = msgs[i % msgs.size()];
+            out.clear();
+            InfluxDBClient::encodeLine(out, "order_book", m.symbol, m.price, m.timestamp,
+                                       m.quantity, m.side, m.orderID, m.attribution, m.matchID);
+            doNotOptimize(out.data());
+        }
+    });
+}
+
+static void benchProcessResponse(BenchRunner &runner, const BenchCorpus &corpus) {
+    const auto &msgs = corpus.messages;
+    runner.run("pipeline/process_response", static_cast<double>(msgs.size()),
+               static_cast<double>(corpus.ndjson.size()), [&](uint64_t n) {
+        for(uint64_t it = 0; it < n; ++it) {
+            BenchPipeline pipe; // fresh state so debug logs don't accumulate across passes
+            for(const auto &m : msgs) {
+                pipe.processor->processResponse(m, "DEV");
+            }
+        }
+    });
+}
+
+static void benchDevMonitor(BenchRunner &runner, const BenchCorpus &corpus) {
+    // Framing, validation and processing exactly as DevMonitor does on stdin
+    runner.run("pipeline/dev_monitor_e2e", static_cast<double>(corpus.messages.size()),
+               static_cast<double>(corpus.ndjson.size()), [&](uint64_t n) {
+        for(uint64_t it = 0; it < n; ++it) {
+            BenchPipeline pipe;
+            std::istringstream input(corpus.ndjson);
+            DevMonitor mon(pipe.processor, input);
+            std::atomic<bool> stop{false};
+            std::atomic<int> requests{0};
+            mon.run(stop, requests);
+            doNotOptimize(requests.load());
+        }
+    });
+
+    // Same corpus handed over as one in-memory range, as a mapped input_file chunk is
+    runner.run("pipeline/dev_monitor_range", static_cast<double>(corpus.messages.size()),
+               static_cast<double>(corpus.ndjson.size()), [&](uint64_t n) {
+        for(uint64_t it = 0; it < n; ++it) {
+            BenchPipeline pipe;
+            DevMonitor mon(pipe.processor);
+            std::atomic<bool> stop{false};
+            std::atomic<int> requests{0};
+            mon.runRange(corpus.ndjson.data(), corpus.ndjson.data() + corpus.ndjson.size(), stop, requests);
+            doNotOptimize(requests.load());
+        }
+    });
+}
+
+static std::string jsonQuote(const std::string &s) {
+    return "\"" + s + "\"";
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions opts;
+    if(!parseArgs(argc, argv, opts)) {
+        return 2;
+    }
+
+    BenchCorpus corpus;
+    if(!opts.corpusPath.empty()) {
+        if(!loadCorpus(opts.corpusPath, corpus)) {
+            std::cerr << "Failed to load corpus from " << opts.corpusPath << std::endl;
+            return 1;
+        }
+    } else {
+        corpus = generateCorpus(opts.messages, opts.symbols, opts.seed);
+    }
+    std::cout << "corpus: " << corpus.messages.size() << " messages, "
+              << corpus.ndjson.size() << " bytes, " << corpus.symbols.size() << " symbols"
+              << std::endl;
+
+    BenchRunner runner(opts.filter, opts.minTime, opts.reps);
+    benchParse(runner, corpus);
+    benchStructuralIndex(runner, corpus);
+    benchNumericFields(runner, corpus);
+    benchTypeDispatch(runner, corpus);
+    benchFraming(runner, corpus);
+    benchStats(runner);
+    benchTickerAppend(runner, corpus);
+    benchTickerConflation(runner, corpus);
+    benchBars(runner, corpus);
+    benchOrderBook(runner, corpus);
+    benchDecimation(runner, opts.seed);
+    benchLineProtocol(runner, corpus);
+    benchProcessResponse(runner, corpus);
+    benchDevMonitor(runner, corpus);
+    benchSymbolFilter(runner, corpus);
+    benchWaitStrategies(runner);
+    benchBoundedQueue(runner, corpus);
+
+    if(!opts.jsonPath.empty()) {
+        std::time_t now = std::time(nullptr);
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        std::vector<std::pair<std::string, std::string>> context = {
+            {"date", jsonQuote(date)},
+            {"hardware_threads", std::to_string(std::thread::hardware_concurrency())},
+            {"corpus", jsonQuote(opts.corpusPath.empty() ? "generated" : opts.corpusPath)},
+            {"corpus_messages", std::to_string(corpus.messages.size())},
+            {"corpus_bytes", std::to_string(corpus.ndjson.size())},
+            {"seed", std::to_string(opts.seed)},
+        };
+        if(!runner.writeJson(opts.jsonPath, context)) {
+            std::cerr << "Failed to write " << opts.jsonPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
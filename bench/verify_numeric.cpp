@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+// bench/verify_numeric.cpp
+////////////////////////////////////////////////////////////////////////////////
+// Checks the tm/q/p decoders of numeric_parse.hpp against std::from_chars
+// on random inputs; run by ctest with the default count.
+//
+//   verify_numeric [count] [seed]
+////////////////////////////////////////////////////////////////////////////////
+#include "numeric_parse.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Writes a random JSON integer of up to 20 digits into buf; returns its length
+static size_t randomInteger(std::mt19937_64 &rng, char* buf) {
+    size_t len = 0;
+    if(rng() & 1) buf[len++] = '-';
+    size_t digits = 1 + rng() % 20;
+    buf[len++] = digits == 1 ? static_cast<char>('0' + rng() % 10) : static_cast<char>('1' + rng() % 9);
+    for(size_t i = 1; i < digits; ++i) buf[len++] = static_cast<char>('0' + rng() % 10);
+    return len;
+}
+
+// Random JSON decimal with up to 12 fraction digits and sometimes an exponent
+static size_t randomDecimal(std::mt19937_64 &rng, char* buf, size_t &fracDigits, bool &exponent) {
+    size_t len = randomInteger(rng, buf);
+    if(len > 11) len = buf[0] == '-' ? 11 : 10; // keep the integer part to 10 digits
+    fracDigits = rng() % 13;
+    if(fracDigits > 0) {
+        buf[len++] = '.';
+        for(size_t i = 0; i < fracDigits; ++i) buf[len++] = static_cast<char>('0' + rng() % 10);
+    }
+    exponent = rng() % 10 == 0;
+    if(exponent) {
+        buf[len++] = rng() & 1 ? 'e' : 'E';
+        uint64_t sign = rng() % 3;
+        if(sign == 1) buf[len++] = '+';
+        if(sign == 2) buf[len++] = '-';
+        size_t digits = 1 + rng() % 3;
+        for(size_t i = 0; i < digits; ++i) buf[len++] = static_cast<char>('0' + rng() % 10);
+    }
+    return len;
+}
+
+/*
+ * Checks the numeric field decoders against std::from_chars on count
+ * random inputs each, and the price ticks against the exact decimal value.
+ * Prices whose ticks do not fit in a long long must be rejected.
+ */
+static bool verifyNumericParsers(uint64_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    char buf[64];
+    uint64_t mismatches = 0;
+    auto report = [&](const char* parser, const char* text, size_t len) {
+        if(mismatches++ < 10) {
+            std::cerr << "mismatch in " << parser << ": " << std::string(text, len) << std::endl;
+        }
+    };
+
+    for(uint64_t i = 0; i < count; ++i) {
+        size_t len = randomInteger(rng, buf);
+        const char* end = buf + len;
+        long long expected64 = 0, got64 = 0;
+        auto res64 = std::from_chars(buf, end, expected64);
+        bool ok64 = parseJsonInt64(buf, end, got64);
+        if(ok64 != (res64.ec == std::errc() && res64.ptr == end) || (ok64 && got64 != expected64)) {
+            report("parseJsonInt64", buf, len);
+        }
+        int expected32 = 0, got32 = 0;
+        auto res32 = std::from_chars(buf, end, expected32);
+        bool ok32 = parseJsonInt32(buf, end, got32);
+        if(ok32 != (res32.ec == std::errc() && res32.ptr == end) || (ok32 && got32 != expected32)) {
+            report("parseJsonInt32", buf, len);
+        }
+
+        size_t fracDigits;
+        bool exponent;
+        len = randomDecimal(rng, buf, fracDigits, exponent);
+        end = buf + len;
+        double expectedPrice = 0, gotPrice = 0;
+        long long ticks = 0;
+        auto resPrice = std::from_chars(buf, end, expectedPrice);
+        bool okPrice = parseJsonPrice(buf, end, gotPrice, ticks);
+
+        // Expected ticks: exact (the digits with the point moved 8 places
+        // right) for plain decimals of up to 8 fraction digits, else rounded
+        bool exact = !exponent && fracDigits <= 8;
+        long long expectedTicks = 0;
+        bool fits;
+        if(exact) {
+            std::string digits;
+            for(size_t j = 0; j < len; ++j) {
+                if(buf[j] != '.') digits += buf[j];
+            }
+            digits.append(8 - fracDigits, '0');
+            auto resTicks = std::from_chars(digits.data(), digits.data() + digits.size(), expectedTicks);
+            fits = resTicks.ec == std::errc();
+        } else {
+            fits = priceToTicks(expectedPrice, expectedTicks);
+        }
+
+        if(okPrice != (resPrice.ec == std::errc() && resPrice.ptr == end && fits) ||
+           (okPrice && std::memcmp(&gotPrice, &expectedPrice, sizeof(double)) != 0)) {
+            report("parseJsonPrice", buf, len);
+        } else if(okPrice && exact && ticks != expectedTicks) {
+            report("parseJsonPrice ticks", buf, len);
+        }
+    }
+    std::cout << "verify_numeric: " << count << " inputs per parser, " << mismatches
+              << " mismatches" << std::endl;
+    return mismatches == 0;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    uint64_t seed = argc > 2 ? std::stoull(argv[2]) : 42;
+    return verifyNumericParsers(count, seed) ? 0 : 1;
+}
@@ -4,71 +4,56 @@
 #ifndef APP_DATA_HPP
 #define APP_DATA_HPP
 
+#include <atomic>
 #include <map>
-#include <vector>
-#include <string>
 #include <memory>
-#include <mutex>
-#include <atomic>
-#include <thread>
+#include <string>
+#include <vector>
 #include <gtk/gtk.h> // Included for GtkListStore
-#include "config.hpp"
-
-// Structure to hold data for each ticker
-struct TickerData {
-    std::vector<double> values;
-    bool logScale = false; // Flag to determine if log-scale is enabled for this ticker
-};
-
-// Structure to hold statistics for each data stream
-struct DataStreamStats {
-    std::atomic<int> messagesReceived{0};
-    std::atomic<int> errors{0};
-};
-
-// Main application data structure
-struct AppData {
-    // Configuration and processing
-    Config config; // Uses Config from config.hpp
-    std::shared_ptr<class InfluxDBClient> dbClient;
-    std::shared_ptr<class DataProcessor> processor;
-
-    // Control flags
-    std::atomic<bool> stopFlag{false};
-    std::atomic<int> requestCount{0};
-    std::atomic<bool> running{false};
+#include "core_data.hpp"
+#include "book_view.hpp"
+#include "graph_renderer.hpp"
 
+// Main application data structure: core pipeline state plus GTK view state
+struct AppData : CoreData {
     // Graph scaling and panning
     std::atomic<bool> globalLogScale{false}; // Optional global log-scale flag
-    double xOffset = 0.0;
-    double xScale = 1.0;
+    double xOffset = 0.0; // Seconds the view is panned back from the newest sample
+    double xScale = 1.0;  // Time zoom, >= 1
     double yScale = 1.0;
+    double yOffset = 0.0; // Vertical pan in visible Y spans
+
+    // Candlestick mode: bars copied from CoreData::bars each frame
+    bool candles = false;
+    long long barIntervalMs = 1000;             // One of config.barIntervals
+    std::map<std::string, BarSeries> barMap;    // Guarded by dataMutex
+
+    // Graph rasterization off the main thread and what it was last asked to draw
+    std::shared_ptr<class GraphRenderer> graphRenderer;
+    std::vector<GraphSeriesState> graphLayout;
+    GraphViewport graphView;
+    int graphWidth = 0;
+    int graphHeight = 0;
+    int graphScale = 1;
 
     // Time tracking
     double lastTime = 0.0;
 
     // UI Components
     GtkWidget *labelStats = nullptr;
+    std::string statsText; // Last text set on labelStats
     GtkWidget *drawingArea = nullptr;
     GtkWidget *textViewDebug = nullptr;
-
-    // Data structures
-    std::map<std::string, std::shared_ptr<DataStreamStats>> dataStreamStats;
-    std::map<std::string, TickerData> tickerMap;
+    std::map<std::string, std::vector<GtkToggleButton*>> symbolToggles; // Every check button of each symbol
 
     // GTK List Store for Data Streams
     GtkListStore* dataStreamsListStore = nullptr; // Added member
 
-    // Mutexes for thread safety
-    std::mutex statsMutex;
-    std::mutex dataMutex;
-    std::mutex debugMutex;
-
-    // Debug logs
-    std::vector<std::string> debugLogs;
+    // GTK List Store for per-stage latency percentiles
+    GtkListStore* latencyListStore = nullptr;
 
-    // Threads
-    std::vector<std::thread> threads;
+    // Book tab (ladder and heatmap of one symbol)
+    std::shared_ptr<BookView> bookView;
 
     // Additional members as needed
 };
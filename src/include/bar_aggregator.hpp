@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/bar_aggregator.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef BAR_AGGREGATOR_HPP
+#define BAR_AGGREGATOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bars kept per symbol and interval; older ones are overwritten
+const size_t BAR_HISTORY = 600;
+
+// One OHLCV bar of trades with tm in [start, start + interval)
+struct Bar {
+    long long start = 0;      // Epoch milliseconds, a multiple of the interval
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    double close = 0.0;
+    long long volume = 0;     // Sum of q
+    uint64_t trades = 0;      // 0 = empty slot
+    long long openTime = 0;   // tm of the trade that set open
+    long long closeTime = 0;  // tm of the trade that set close
+
+    void add(long long tm, double price, int quantity) {
+        if(trades == 0) {
+            open = high = low = close = price;
+            openTime = closeTime = tm;
+        } else {
+            if(price > high) high = price;
+            if(price < low) low = price;
+            // Trades may arrive out of tm order; open and close follow tm
+            if(tm < openTime) {
+                open = price;
+                openTime = tm;
+            }
+            if(tm >= closeTime) {
+                close = price;
+                closeTime = tm;
+            }
+        }
+        volume += quantity;
+        trades++;
+    }
+};
+
+// Bars of one symbol at one interval, oldest first
+struct BarSeries {
+    long long intervalMs = 0;
+    uint64_t version = 0; // BarAggregator::version when copied
+    std::vector<Bar> bars;
+};
+
+// Config spelling of an interval: a count and a unit, e.g. "1s", "1m", "5m", "1h"
+std::string barIntervalName(long long intervalMs);
+bool parseBarInterval(const std::string &text, long long &intervalMs);
+
+// Comma-separated intervals, e.g. "1s,1m,5m"; false (intervals untouched) if any is invalid
+bool parseBarIntervals(const std::string &text, std::vector<long long> &intervalsMs);
+
+/*
+ * Per-symbol OHLCV bars at every configured interval, updated in place by
+ * the processing threads. Each interval is a ring of BAR_HISTORY bars
+ * addressed by bucket number (tm / interval), so a trade costs one slot
+ * update per interval whatever the rate: a slot still holding an older
+ * bucket is restarted, and a trade older than the ring is counted in
+ * lateTrades and dropped. Readers copy a symbol's bars under its lock.
+ */
+class BarAggregator {
+public:
+    BarAggregator();
+    ~BarAggregator();
+
+    // Writer side; any thread
+    void add(const std::string &symbol, long long tm, double price, int quantity);
+
+    // Bumped by every trade of the symbol; 0 = none yet
+    uint64_t version(const std::string &symbol) const;
+
+    // Refreshes out with the symbol's bars at intervalMs unless it already
+    // holds that version; true if out changed
+    bool snapshot(const std::string &symbol, long long intervalMs, BarSeries &out) const;
+
+    const std::vector<long long> &intervals() const { return intervalsMs; }
+
+    // Drops every bar and switches to the given intervals; call while no writer runs
+    void reset(const std::vector<long long> &intervals);
+
+    std::atomic<uint64_t> lateTrades{0};
+
+private:
+    struct Ring {
+        std::vector<Bar> slots;
+        long long newest = 0; // Newest bucket seen
+        bool started = false;
+    };
+
+    struct SymbolBars {
+        mutable std::mutex mutex; // Guards rings
+        std::vector<Ring> rings;  // One per intervalsMs entry
+        std::atomic<uint64_t> version{0};
+    };
+
+    std::vector<long long> intervalsMs;
+    mutable std::shared_mutex symbolsMutex; // Guards symbols (not their bars)
+    std::unordered_map<std::string, std::unique_ptr<SymbolBars>> symbols;
+
+    SymbolBars* find(const std::string &symbol) const;
+    SymbolBars* findOrCreate(const std::string &symbol);
+};
+
+#endif // BAR_AGGREGATOR_HPP
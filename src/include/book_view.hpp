@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/book_view.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef BOOK_VIEW_HPP
+#define BOOK_VIEW_HPP
+
+#include <string>
+#include <vector>
+#include <cairo.h>
+#include <gtk/gtk.h>
+#include "order_book.hpp"
+
+struct AppData;
+
+// Levels per side listed in the ladder
+const size_t BOOK_LADDER_LEVELS = 20;
+
+// Levels per side sampled into each heatmap column
+const size_t BOOK_HEATMAP_LEVELS = 100;
+
+// The book is sampled (one heatmap column) this often
+const int BOOK_SAMPLE_MS = 100;
+
+/*
+ * Time x price liquidity heatmap of one symbol. Every sample adds a column
+ * of resting size per price; the columns live in a ring of stored samples
+ * and in an image surface used as the same ring, so a sample renders only
+ * its own column and the draw handler blits the surface in two pieces,
+ * oldest first. Everything is redrawn only when the size changes, the mid
+ * price leaves the middle half of the view or a level outgrows the colour
+ * scale.
+ */
+class BookHeatmap {
+public:
+    BookHeatmap();
+    ~BookHeatmap();
+
+    // Adds depth as the newest column of a width x height (widget pixels) map
+    void push(const BookDepth &depth, int width, int height, int scale);
+
+    // Main thread draw handler
+    void draw(cairo_t* cr, int width, int height);
+
+    void clear();
+
+private:
+    struct Column {
+        std::vector<BookLevel> bids;
+        std::vector<BookLevel> asks;
+    };
+
+    std::vector<Column> columns;   // Ring of samples; slot i is drawn at x = i * column width
+    size_t head = 0;               // Next slot to write
+    size_t count = 0;              // Slots holding a sample
+    cairo_surface_t* surface = nullptr;
+    int width = 0;
+    int height = 0;
+    int scale = 1;
+    long long step = 0;            // Price ticks per row; 0 until two levels were seen
+    long long anchor = 0;          // Price at the middle row
+    long long fullQuantity = 0;    // Level size drawn at full intensity
+
+    double rowY(long long priceTicks) const;
+    void renderColumn(cairo_t* cr, size_t slot);
+    void renderAll();
+};
+
+// State of the Book tab
+struct BookView {
+    std::string symbol;
+    BookDepth depth;               // Newest sample
+    uint64_t ladderVersion = 0;    // depth.version the ladder shows
+    GtkListStore* ladderStore = nullptr;
+    GtkWidget* heatmapArea = nullptr;
+    BookHeatmap heatmap;
+};
+
+void setup_book_tab(AppData* app, GtkWidget* notebook);
+void book_symbol_changed(GtkComboBox* combo, gpointer user_data);
+gboolean book_heatmap_on_draw(GtkWidget* widget, cairo_t* cr, gpointer user_data);
+gboolean update_book_view(gpointer user_data);
+
+#endif // BOOK_VIEW_HPP
@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/bounded_queue.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "wait_strategy.hpp"
+
+/*
+ * How a queue bounds its contents. The first three only act once the
+ * queue is full and decide what happens to one more item:
+ *   Block      - the producer waits for room (until the queue is closed)
+ *   DropOldest - the oldest queued item is discarded
+ *   DropNewest - the new item is discarded
+ * Conflate acts on every push, full or not: an item whose key is already
+ * queued replaces that item in place, at whatever depth it sits. Items
+ * with a new key are appended, and a full queue then drops its oldest.
+ */
+enum class OverflowPolicy {
+    Block,
+    DropOldest,
+    DropNewest,
+    Conflate
+};
+
+// Config spelling: "block", "drop_oldest", "drop_newest", "conflate"
+const char* overflowPolicyName(OverflowPolicy policy);
+bool parseOverflowPolicy(const std::string &text, OverflowPolicy &policy);
+
+/*
+ * Multi-producer, multi-consumer FIFO that never holds more than capacity
+ * items. Every item the policy discards is counted in dropped; with
+ * Conflate the key of an item comes from keyOf, and an empty key is never
+ * conflated. Consumers and blocked producers wait with the given mode.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    using KeyFunction = std::function<std::string(const T &)>;
+
+    BoundedQueue(size_t capacity, OverflowPolicy policy, WaitMode waitMode = WaitMode::Park,
+                 KeyFunction keyOf = nullptr)
+        : limit(capacity > 0 ? capacity : 1), overflow(policy), keyFor(std::move(keyOf)),
+          notEmpty(waitMode), notFull(waitMode) {}
+
+    // False if the item was dropped (DropNewest, or the queue is closed)
+    bool push(T item) {
+        std::string key;
+        if(overflow == OverflowPolicy::Conflate && keyFor) key = keyFor(item);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while(true) {
+            if(isClosed) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if(!key.empty()) {
+                auto it = pendingKeys.find(key);
+                if(it != pendingKeys.end()) {
+                    items[static_cast<size_t>(it->second - headSeq)].second = std::move(item);
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            if(items.size() < limit) break;
+
+            if(overflow == OverflowPolicy::DropNewest) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if(overflow != OverflowPolicy::Block) {
+                popFront();
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            lock.unlock();
+            notFull.waitUntil([this] {
+                return depth.load(std::memory_order_acquire) < limit || closed.load(std::memory_order_acquire);
+            }, std::chrono::milliseconds(100));
+            lock.lock();
+        }
+
+        if(!key.empty()) pendingKeys.emplace(key, headSeq + items.size());
+        items.emplace_back(std::move(key), std::move(item));
+        depth.store(items.size(), std::memory_order_release);
+        pushed.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+        notEmpty.notify();
+        return true;
+    }
+
+    // Waits up to timeout for an item; false if none came or the queue is closed and empty
+    bool pop(T &out, std::chrono::nanoseconds timeout) {
+        notEmpty.waitUntil([this] {
+            return depth.load(std::memory_order_acquire) > 0 || closed.load(std::memory_order_acquire);
+        }, timeout);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if(items.empty()) return false;
+        out = std::move(items.front().second);
+        popFront();
+        lock.unlock();
+        notFull.notify();
+        return true;
+    }
+
+    // Rejects further pushes and wakes every waiter; queued items can still be popped
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isClosed = true;
+            closed.store(true, std::memory_order_release);
+        }
+        notEmpty.notify();
+        notFull.notify();
+    }
+
+    // Closed and nothing left to pop
+    bool drained() const { return closed.load(std::memory_order_acquire) && size() == 0; }
+
+    size_t size() const { return depth.load(std::memory_order_acquire); }
+    size_t capacity() const { return limit; }
+    OverflowPolicy policy() const { return overflow; }
+
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> dropped{0}; // Discarded or conflated away
+
+private:
+    const size_t limit;
+    const OverflowPolicy overflow;
+    KeyFunction keyFor;
+
+    std::mutex mutex; // Guards items, pendingKeys, headSeq, isClosed
+    std::deque<std::pair<std::string, T>> items;  // Conflation key (if any) and item
+    std::unordered_map<std::string, uint64_t> pendingKeys; // Key -> sequence of its queued item
+    uint64_t headSeq = 0;                                    // Sequence of items.front()
+    bool isClosed = false;
+
+    std::atomic<size_t> depth{0};    // items.size(), readable without the lock
+    std::atomic<bool> closed{false};
+    WaitStrategy notEmpty;
+    WaitStrategy notFull;
+
+    // Caller holds mutex
+    void popFront() {
+        if(!items.front().first.empty()) pendingKeys.erase(items.front().first);
+        items.pop_front();
+        headSeq++;
+        depth.store(items.size(), std::memory_order_release);
+    }
+};
+
+#endif // BOUNDED_QUEUE_HPP
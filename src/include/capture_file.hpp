@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/capture_file.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef CAPTURE_FILE_HPP
+#define CAPTURE_FILE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mapped_file.hpp"
+
+/*
+ * Capture file layout (native little-endian):
+ *
+ *   header  "HFCAP001" | u64 capture start (ns since epoch)
+ *   record  u64 receive time (ns since epoch) | u32 length | payload bytes
+ *   ...
+ *   index   u64 file offset of every CAPTURE_INDEX_STRIDE-th record
+ *   footer  u64 index offset | u64 record count | u32 stride | u32 0 | "HFCAPIDX"
+ *
+ * The index and footer are only written by a clean close(); a capture cut
+ * short by a crash is still readable by scanning the records.
+ */
+static const uint32_t CAPTURE_INDEX_STRIDE = 1024;
+
+// True if data starts with the capture file magic
+bool isCaptureData(const char* data, size_t size);
+
+/*
+ * Appends raw inbound messages to a capture file. record() only copies
+ * into a pending buffer under a mutex; a background thread writes the
+ * buffer out every 100 ms or once it exceeds flushBytes.
+ */
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    // Creates path and starts the writer thread; false if already open or on I/O error
+    bool open(const std::string &path, size_t flushBytes = 1 << 20);
+
+    // Flushes pending records, writes the index and footer and closes the file
+    void close();
+
+    bool active() const { return capturing.load(std::memory_order_relaxed); }
+
+    // Stamps the receive time and queues one message; no-op unless open
+    void record(const char* data, size_t size);
+    void record(const std::string &message) { record(message.data(), message.size()); }
+
+    // Writer statistics
+    std::atomic<uint64_t> recordsCaptured{0};
+    std::atomic<uint64_t> bytesCaptured{0};
+    std::atomic<uint64_t> writeFailures{0};
+
+private:
+    std::atomic<bool> capturing{false};
+
+    // Guarded by mutex
+    std::mutex mutex;
+    std::condition_variable flushCv;
+    bool stopRequested = false;
+    std::string pending;
+    uint64_t appendedBytes = 0;     // File offset the next record will start at
+    uint64_t recordCount = 0;
+    std::vector<uint64_t> index;
+    size_t flushThreshold = 1 << 20;
+
+    std::string flushBuffer;        // Owned by the writer thread
+    std::FILE* file = nullptr;
+    std::thread writerThread;
+
+    void writerLoop();
+    bool writeOut(const std::string &bytes);
+};
+
+// One captured message; data points into the mapped file
+struct CaptureRecord {
+    uint64_t receiveNs;
+    const char* data;
+    uint32_t size;
+};
+
+/*
+ * Zero-copy reader over an mmapped capture file.
+ */
+class CaptureReader {
+public:
+    // Maps and validates path; false with error set if it is not a capture file
+    bool open(const std::string &path, std::string &error);
+
+    uint64_t recordCount() const { return count; }
+    uint64_t startNs() const { return captureStartNs; }
+
+    // True if the file has an index (it was closed cleanly)
+    bool indexed() const { return indexData != nullptr; }
+
+    // Positions the cursor on record n (0-based); false past the end
+    bool seek(uint64_t n);
+
+    // Reads the record at the cursor and advances; false at the end
+    bool next(CaptureRecord &out);
+
+private:
+    MappedFile file;
+    uint64_t captureStartNs = 0;
+    size_t dataEnd = 0;              // End of the record area
+    size_t cursor = 0;
+    uint64_t count = 0;
+    const char* indexData = nullptr; // CAPTURE_INDEX_STRIDE-spaced record offsets
+    uint64_t indexEntries = 0;
+    uint32_t stride = CAPTURE_INDEX_STRIDE;
+
+    // Reads the record header at offset; false if it is truncated
+    bool recordAt(size_t offset, CaptureRecord &out, size_t &nextOffset) const;
+};
+
+#endif // CAPTURE_FILE_HPP
@@ -6,20 +6,64 @@
 
 #include <string>
 #include <vector>
+#include "bounded_queue.hpp"
+#include "wait_strategy.hpp"
 
 enum class DataMode {
     DEV,
-    REAL
+    REAL,
+    REPLAY  // Feeds replayFile through a single DevMonitor
 };
 
+const char* dataModeName(DataMode mode);
+
 struct Config {
     std::string sessionID;
     std::string influxURL;
     std::string influxDB;
     int totalCores;
     int reserveCores;
+    bool threadPinning;          // Pin pipeline threads (see ThreadPlacement)
+    std::string pinCpus;         // CPU list the pinned threads may use, e.g. "2-7" (empty = all)
     std::vector<std::string> symbols;
+    bool symbolFilter;           // Drop messages for symbols not in symbols (toggles edit the set)
     DataMode dataMode;
+    bool latencyRecording;       // Record per-stage latency histograms
+    std::string latencyDumpPath; // Histogram dump written on stop (empty = off)
+    std::string traceDumpPath;   // Chrome trace JSON (HF_TRACE builds only)
+    std::vector<long long> barIntervals; // OHLCV bar intervals in ms; the first is charted by default
+    bool orderBook;              // Maintain the per-symbol order book (Book tab)
+
+    // Storage writer (batched by hf_server)
+    bool influxHttp;             // POST batches to influxURL instead of printing them
+    int influxBatchBytes;        // Flush once this many bytes are pending
+    int influxFlushMs;           // ...or at least this often
+    WaitMode dbWriterWait;       // How the writer thread waits for a full batch
+    int influxMaxPendingBytes;   // Bound on the unflushed batch (0 = unbounded)
+    OverflowPolicy influxOverflow; // What write() does once it is reached
+
+    // Headless server
+    std::string metricsFile;     // Stats snapshot rewritten every metricsIntervalMs
+    int metricsIntervalMs;
+    int shutdownTimeoutMs;       // How long SIGTERM waits for monitors to drain
+
+    // Prometheus endpoint (GET /metrics)
+    int metricsPort;             // 0 = disabled
+    std::string metricsBind;
+
+    // DEV stdin: framer -> workers queue (0 = each monitor reads and processes itself)
+    int ingestQueue;                     // Capacity in messages
+    OverflowPolicy ingestQueuePolicy;
+    WaitMode ingestQueueWait;
+
+    // DEV input: mapped NDJSON or capture file split across the monitors (empty = stdin)
+    std::string inputFile;
+
+    // Record/replay
+    std::string captureFile;     // Raw inbound messages are captured here (empty = off)
+    std::string replayFile;      // Capture replayed in REPLAY mode
+    double replaySpeed;          // 1 = original pacing, N = N times faster, 0 = as fast as possible
+    long long replayStart;       // First record to replay (0-based)
 };
 
 Config loadConfig(const std::string &filename);
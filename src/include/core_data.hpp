@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// include/core_data.hpp
+///////////////////////////////////////////////////////////////////////////////
+#ifndef CORE_DATA_HPP
+#define CORE_DATA_HPP
+
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include "config.hpp"
+#include "bar_aggregator.hpp"
+#include "bounded_queue.hpp"
+#include "capture_file.hpp"
+#include "order_book.hpp"
+#include "symbol_filter.hpp"
+#include "thread_placement.hpp"
+#include "ticker_conflator.hpp"
+
+// Structure to hold data for each ticker
+struct TickerData {
+    std::vector<double> values;
+    std::vector<double> times; // Seconds (monotonic) of each value, non-decreasing
+    bool logScale = false; // Flag to determine if log-scale is enabled for this ticker
+    uint64_t version = 0;  // Bumped whenever values change
+
+    // Appends a sample, keeping only the newest maxSize values
+    void append(double time, double value, size_t maxSize) {
+        values.push_back(value);
+        times.push_back(time);
+        version++;
+        trimTo(maxSize);
+    }
+
+    // Appends one conflated interval as up to three samples at time: low
+    // and high in the order they happened, then the last price
+    void appendInterval(const TickerInterval &interval, double time, size_t maxSize) {
+        if(interval.count == 0) return;
+        double first = interval.lowFirst ? interval.low : interval.high;
+        double second = interval.lowFirst ? interval.high : interval.low;
+        values.push_back(first);
+        if(second != first) values.push_back(second);
+        if(interval.last != values.back()) values.push_back(interval.last);
+        times.resize(values.size(), time);
+        version++;
+        trimTo(maxSize);
+    }
+
+    void clear() {
+        values.clear();
+        times.clear();
+        version++;
+    }
+
+    // Drops the samples older than time
+    void trimBefore(double time) {
+        size_t old = std::lower_bound(times.begin(), times.end(), time) - times.begin();
+        if(old == 0) return;
+        values.erase(values.begin(), values.begin() + old);
+        times.erase(times.begin(), times.begin() + old);
+        version++;
+    }
+
+private:
+    void trimTo(size_t maxSize) {
+        if(values.size() > maxSize) {
+            values.erase(values.begin(), values.end() - maxSize);
+            times.erase(times.begin(), times.end() - maxSize);
+        }
+    }
+};
+
+// Structure to hold statistics for each data stream
+struct DataStreamStats {
+    std::atomic<int> messagesReceived{0};
+    std::atomic<int> errors{0};
+};
+
+/*
+ * Ingest, processing and storage state shared by the monitor threads.
+ * Contains nothing GUI-specific so it can be used headless; the GTK
+ * front end extends it as AppData.
+ */
+struct CoreData {
+    // Configuration and processing
+    Config config; // Uses Config from config.hpp
+    std::shared_ptr<class InfluxDBClient> dbClient;
+    std::shared_ptr<class DataProcessor> processor;
+    CaptureWriter capture; // Open while monitors run with config.captureFile set
+    SymbolFilter symbolFilter; // Subscribed symbols, checked by the monitors at ingress
+    ThreadPlacement placement; // CPUs of the pipeline threads (config.threadPinning)
+    std::shared_ptr<BoundedQueue<std::string>> ingestQueue; // Set while a split DEV ingest runs
+
+    // Control flags
+    std::atomic<bool> stopFlag{false};
+    std::atomic<int> requestCount{0};
+    std::atomic<bool> running{false};
+    std::atomic<int> activeMonitors{0}; // Monitor threads that have not returned yet
+
+    // Data structures
+    std::map<std::string, std::shared_ptr<DataStreamStats>> dataStreamStats;
+    std::map<std::string, TickerData> tickerMap;    // Graph history, filled by the UI from tickerConflator
+    TickerConflator tickerConflator;                 // Per-frame prices written by the processors
+    BarAggregator bars;                              // OHLCV bars of the fills at config.barIntervals
+    OrderBook book;                                  // Price levels per symbol (config.orderBook)
+
+    // Mutexes for thread safety
+    std::mutex statsMutex;
+    std::mutex dataMutex;
+    std::mutex debugMutex;
+
+    // Debug logs
+    std::vector<std::string> debugLogs;
+
+    // Threads
+    std::vector<std::thread> threads;
+};
+
+#endif // CORE_DATA_HPP
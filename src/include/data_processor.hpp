@@ -5,37 +5,106 @@
 #define DATA_PROCESSOR_HPP
 
 #include <string>
+#include <array>
+#include <deque>
 #include <atomic>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
+#include "latency_histogram.hpp"
+#include "mbo_type.hpp"
 
 // Forward declarations
 class InfluxDBClient;
-struct AppData;
+struct CoreData;
+struct MboMessage;
+struct DataStreamStats;
 
 /*
  * Handles parsing of MBO data and updates statistics for each data stream.
  */
 class DataProcessor {
 public:
-    DataProcessor(std::shared_ptr<InfluxDBClient> dbClient, AppData* app);
+    DataProcessor(std::shared_ptr<InfluxDBClient> dbClient, CoreData* core);
     ~DataProcessor();
 
     // Processes a response string for a specific streamID
     void processResponse(const std::string &response, const std::string &streamID);
 
-    // Retrieves the list of debug logs
+    // Same as processResponse for a message already decoded from raw (e.g. by MboBlockDecoder)
+    void processDecoded(const MboMessage &msg, const std::string &raw, const std::string &streamID);
+
+    /*
+     * Ingress check against CoreData::symbolFilter: false (and counted in
+     * filteredCount) if the message's symbol is not subscribed. Messages
+     * whose symbol cannot be found cheaply are let through to the parser.
+     */
+    bool admitSymbol(const char* data, size_t size);
+
+    // admitSymbol for a symbol already located in the message
+    bool admitSymbolName(const char* symbol, size_t length);
+
+    // Appends a raw inbound message to the session capture, if one is open
+    void captureInbound(const std::string &raw);
+
+    // Counts one message for streamID; false if its stats entry could not be created
+    bool recordStreamMessage(const std::string &streamID);
+
+    // Finds or creates (and exposes as metrics) the stats entry for streamID
+    std::shared_ptr<DataStreamStats> streamStats(const std::string &streamID);
+
+    // Retrieves the newest debug logs (at most DEBUG_LOG_LIMIT)
     std::vector<std::string> getDebugLogs();
 
+    // Debug log entries discarded, oldest first, to stay within the limit
+    std::atomic<uint64_t> debugLogsDropped{0};
+
     // Public error count
     std::atomic<int> errorCount{0};
 
+    // Messages dropped by admitSymbol
+    std::atomic<uint64_t> filteredCount{0};
+
+    // Processed messages per decoded type (Unknown included)
+    std::array<std::atomic<uint64_t>, MBO_TYPE_COUNT> typeCounts{};
+
+    // Messages per unhandled type tag
+    std::map<std::string, uint64_t> unknownTypeCounts();
+
+    // Per-stage latency histograms for the ingest path
+    LatencyRecorder latency;
+
 private:
     std::shared_ptr<InfluxDBClient> db;  // InfluxDB client for data storage
-    AppData* appData;                     // Pointer to shared application data
+    CoreData* coreData;                   // Pointer to shared pipeline state
     std::mutex debugMutex;                // Mutex to protect debug logs
-    std::vector<std::string> debugLogs;   // Container for debug log entries
+    std::deque<std::string> debugLogs;    // Container for debug log entries
+
+    // Stats, ticker and storage steps shared by both entry points
+    void processMessage(const MboMessage &msg, const std::string &response,
+                        const std::string &streamID, StageClock &clock);
+
+    // Feeds one message to the sinks MboTypeTraits<T> declares (mbo_pipeline.hpp)
+    template <MboType T>
+    void runPipeline(const MboMessage &msg, const std::string &response,
+                     const std::string &streamID, StageClock &clock);
+
+    using Pipeline = void (DataProcessor::*)(const MboMessage &, const std::string &,
+                                             const std::string &, StageClock &);
+    static const std::array<Pipeline, MBO_TYPE_COUNT> pipelines; // Indexed by MboType
+
+    template <size_t... I>
+    static constexpr std::array<Pipeline, MBO_TYPE_COUNT> makePipelines(std::index_sequence<I...>) {
+        return {{&DataProcessor::runPipeline<static_cast<MboType>(I)>...}};
+    }
+
+    // Counts a message whose type has no handler; only the first of each tag is logged
+    void countUnknownType(const std::string &tag, const std::string &response);
+
+    std::mutex unknownTypesMutex;
+    std::map<std::string, std::shared_ptr<std::atomic<uint64_t>>> unknownTypes;
 
     // Tracks statistics and errors for streams
     void incrementStreamError(const std::string &streamID);
@@ -4,8 +4,12 @@
 #ifndef DEV_MONITOR_HPP
 #define DEV_MONITOR_HPP
 
+#include "bounded_queue.hpp"
 #include "data_processor.hpp"
+#include "latency_histogram.hpp"
 #include <atomic>
+#include <cstdint>
+#include <iostream>
 #include <thread>
 #include <memory>
 #include <string>
@@ -15,14 +19,47 @@
  */
 class DevMonitor {
 public:
-    DevMonitor(std::shared_ptr<DataProcessor> processor);
+    // Reads newline-delimited JSON from input (std::cin unless given)
+    DevMonitor(std::shared_ptr<DataProcessor> processor, std::istream &input = std::cin);
     ~DevMonitor();
     
     // Starts the monitoring loop
     void run(std::atomic<bool> &stopFlag, std::atomic<int> &requestCount);
 
+    /*
+     * Feeds every record of a capture through the same validation and
+     * processing path as live input, in file order. speed 1 reproduces the
+     * original receive-time gaps, N divides them by N, 0 does not wait.
+     * Stops after recordLimit records.
+     */
+    void replay(class CaptureReader &capture, double speed, uint64_t recordLimit,
+                const std::string &streamID, std::atomic<bool> &stopFlag, std::atomic<int> &requestCount);
+
+    /*
+     * Processes the newline-delimited messages in [begin, end), e.g. one
+     * chunk of a mapped file. Lines are decoded a block at a time with
+     * MboBlockDecoder; lines it leaves out go through the per-message path.
+     */
+    void runRange(const char* begin, const char* end,
+                  std::atomic<bool> &stopFlag, std::atomic<int> &requestCount);
+
+    /*
+     * Split ingest over a bounded queue: runReader frames the input into
+     * queue (capture and the symbol filter apply here) and closes it at end
+     * of input; any number of runWorker threads validate and process what
+     * was queued until it is drained.
+     */
+    void runReader(BoundedQueue<std::string> &queue, std::atomic<bool> &stopFlag);
+    void runWorker(BoundedQueue<std::string> &queue, std::atomic<bool> &stopFlag,
+                   std::atomic<int> &requestCount);
+
 private:
     std::shared_ptr<DataProcessor> dataProcessor;
+    std::istream* input;
+
+    // Validates one framed message and hands it to the processor
+    void handleMessage(const std::string &message, const std::string &streamID,
+                       StageClock &clock, std::atomic<int> &requestCount);
 };
 
 #endif // DEV_MONITOR_HPP
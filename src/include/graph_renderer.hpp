@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/graph_renderer.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef GRAPH_RENDERER_HPP
+#define GRAPH_RENDERER_HPP
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cairo.h>
+#include <gtk/gtk.h>
+#include "core_data.hpp"
+#include "wait_strategy.hpp"
+
+// Seconds of history kept per ticker, all of it shown at xScale 1
+const double GRAPH_HISTORY_SECONDS = 60.0;
+
+// Bars shown at xScale 1 in candlestick mode
+const double GRAPH_CANDLES_VISIBLE = 60.0;
+
+// The time axis end moves in steps of 1/GRAPH_AXIS_STEPS of the visible
+// window (one bar in candlestick mode at xScale 1)
+const double GRAPH_AXIS_STEPS = 60.0;
+
+// Area of stacked sub-graph index (of count) in a width x height graph,
+// including its title and axis labels; the regions tile without overlap
+GdkRectangle graphRegion(int width, int height, size_t count, size_t index);
+
+// Plot area size of each sub-graph, without margins and labels
+double graphPlotWidth(int width);
+double graphPlotHeight(int height, size_t count);
+
+/*
+ * Pan and zoom shared by all sub-graphs. The visible time window is
+ * graphWindowSeconds() wide and ends xOffset seconds before the newest
+ * sample (or the end of the newest bar), rounded up to the next axis step.
+ * Each Y axis fits the visible
+ * samples, is divided by yScale and moved by yOffset visible spans.
+ */
+struct GraphViewport {
+    double xScale = 1.0;
+    double xOffset = 0.0;
+    double yScale = 1.0;
+    double yOffset = 0.0;
+    bool candles = false;        // OHLCV bars instead of the price line
+    long long barIntervalMs = 0; // Bars drawn in candlestick mode
+
+    bool operator==(const GraphViewport &other) const {
+        return xScale == other.xScale && xOffset == other.xOffset &&
+               yScale == other.yScale && yOffset == other.yOffset &&
+               candles == other.candles && barIntervalMs == other.barIntervalMs;
+    }
+};
+
+// Seconds the time axis spans: GRAPH_HISTORY_SECONDS, or GRAPH_CANDLES_VISIBLE
+// bars in candlestick mode, divided by xScale
+double graphWindowSeconds(const GraphViewport &view);
+
+// What one sub-graph shows; a frame redraws the sub-graphs whose entry changed
+struct GraphSeriesState {
+    std::string symbol;
+    uint64_t version = 0; // TickerData::version, or BarSeries::version in candlestick mode
+    bool logScale = false;
+
+    bool operator==(const GraphSeriesState &other) const {
+        return symbol == other.symbol && version == other.version && logScale == other.logScale;
+    }
+};
+
+// Everything the worker needs for one frame
+struct GraphFrameRequest {
+    int width = 0;
+    int height = 0;
+    int scale = 1;                              // Device pixels per widget pixel
+    GraphViewport view;
+    std::vector<GraphSeriesState> layout;       // Non-empty tickers in graph order
+    std::map<std::string, TickerData> changed;  // Series whose version moved since the last request
+    std::map<std::string, BarSeries> changedBars; // The same in candlestick mode
+};
+
+/*
+ * Rasterizes the stacked ticker graphs on a worker thread. The GTK main
+ * thread submits snapshots; the worker renders them into the back one of
+ * two image surfaces, redrawing only the sub-graphs that changed since
+ * that surface was last drawn, then swaps and asks the main thread to
+ * repaint the damaged regions. The draw handler only blits the front
+ * surface. A request still waiting when the next one arrives is merged
+ * into it and counted as a dropped frame.
+ */
+class GraphRenderer {
+public:
+    explicit GraphRenderer(GtkWidget* widget);
+    ~GraphRenderer();
+
+    void start();
+    void stop();
+
+    // Main thread: hands over the next frame
+    void submit(GraphFrameRequest request);
+
+    // Main thread: paints the newest completed frame
+    void blit(cairo_t* cr);
+
+    uint64_t framesRendered() const { return rendered.load(std::memory_order_relaxed); }
+    uint64_t framesDropped() const { return dropped.load(std::memory_order_relaxed); }
+    double lastFrameSeconds() const { return lastFrame.load(std::memory_order_relaxed); }
+
+private:
+    // One of the two image surfaces and the sub-graphs it currently shows
+    struct Frame {
+        cairo_surface_t* surface = nullptr;
+        int width = 0;
+        int height = 0;
+        int scale = 1;
+        GraphViewport view;
+        double newest = 0.0; // Right edge of the time axis before xOffset
+        std::vector<GraphSeriesState> layout;
+    };
+
+    GtkWidget* widget;
+    std::thread worker;
+    std::atomic<bool> stopRequested{false};
+
+    std::mutex requestMutex; // Guards pending and hasPending
+    GraphFrameRequest pending;
+    bool hasPending = false;
+    std::atomic<bool> requestReady{false};
+    WaitStrategy requestWait;
+
+    std::mutex frameMutex; // Guards front and damage; held while blitting
+    Frame frames[2];
+    int front = 0;
+    std::vector<GdkRectangle> damage;   // Regions to repaint once the main thread runs
+    std::atomic<bool> repaintQueued{false};
+
+    std::map<std::string, TickerData> series; // Worker-only: latest data of each plotted ticker
+    std::map<std::string, BarSeries> bars;    // Worker-only: latest bars of each plotted ticker
+    struct Layer;
+    std::map<std::string, std::unique_ptr<Layer>> layers; // Worker-only: cached grid and labels
+    std::vector<std::pair<double, double>> decimated;     // Worker-only: visible (time, value) samples
+
+    std::atomic<uint64_t> rendered{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<double> lastFrame{0.0};
+
+    void run();
+    void render(GraphFrameRequest &request);
+    void drawGraph(cairo_t* cr, const GraphFrameRequest &request, size_t index, double newest);
+    static gboolean on_frame_ready(gpointer user_data);
+};
+
+#endif // GRAPH_RENDERER_HPP
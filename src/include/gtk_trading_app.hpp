@@ -9,12 +9,21 @@
 
 void start_monitoring(GtkButton* button, gpointer user_data);
 void stop_monitoring(GtkButton* button, gpointer user_data);
+void dump_trace(GtkButton* button, gpointer user_data);
 void toggle_data_mode(GtkButton* button, gpointer user_data);
 void ticker_toggle_changed(GtkToggleButton* toggle, gpointer user_data);
 void ticker_log_toggle_changed(GtkToggleButton* toggle, gpointer user_data);
+void graph_candles_toggled(GtkToggleButton* toggle, gpointer user_data);
+void bar_interval_changed(GtkComboBox* combo, gpointer user_data);
 void setup_data_streams_tab(AppData* app, GtkWidget* notebook);
+void setup_latency_tab(AppData* app, GtkWidget* notebook);
+void latency_record_toggled(GtkToggleButton* toggle, gpointer user_data);
 gboolean update_ui(gpointer user_data);
+
+// Submits a graph frame now (after a pan, zoom or scale change) instead of on the next tick
+void requestGraphFrame(AppData* app);
 gboolean update_debug_text(gpointer user_data);
 gboolean update_data_streams(gpointer user_data);
+gboolean update_latency_view(gpointer user_data);
 
 #endif // GTK_TRADING_APP_HPP
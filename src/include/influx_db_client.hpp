@@ -7,6 +7,14 @@
 #include <string>
 #include <mutex>
 #include <memory>
+#include <ostream>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "bounded_queue.hpp"
+#include "latency_histogram.hpp"
+#include "wait_strategy.hpp"
 
 class InfluxDBClient {
 public:
@@ -23,10 +31,82 @@ public:
                const std::string &attribution,
                const std::string &matchID);
 
+    // Appends one InfluxDB line-protocol record (millisecond timestamp) to out
+    static void encodeLine(std::string &out,
+                           const std::string &measurement,
+                           const std::string &symbol,
+                           double price,
+                           long long timestamp,
+                           int quantity,
+                           const std::string &side,
+                           const std::string &orderID,
+                           const std::string &attribution,
+                           const std::string &matchID);
+
+    // Redirects the mock write output (std::cout by default)
+    void setOutput(std::ostream *stream);
+
+    /*
+     * Switches write() to batching: lines are only encoded into a pending
+     * buffer and a background thread flushes it every flushIntervalMs or
+     * once it exceeds maxBatchBytes, either as an HTTP POST to
+     * <url>/write?db=<db>&precision=ms (http) or to the mock output.
+     * The writer waits for a full batch as writerWait says, and is pinned
+     * to writerCpus when given.
+     */
+    void startBatching(bool http, size_t maxBatchBytes, int flushIntervalMs,
+                       WaitMode writerWait = WaitMode::Park, const std::vector<int> &writerCpus = {});
+
+    /*
+     * Bounds the pending batch to maxBytes (0 = unbounded) while batching.
+     * Once it is full, Block stalls write() until the writer takes the
+     * batch, DropNewest discards the new line, and DropOldest discards the
+     * older half of the batch. Rows have no conflation key, so config
+     * rejects Conflate; passed here it acts as DropOldest. Call before
+     * startBatching.
+     */
+    void setPendingLimit(size_t maxBytes, OverflowPolicy policy);
+
+    // Flushes everything still pending and stops the writer thread
+    void stopBatching();
+
+    // Writer statistics
+    std::atomic<uint64_t> linesQueued{0};
+    std::atomic<uint64_t> linesFlushed{0};
+    std::atomic<uint64_t> bytesFlushed{0};
+    std::atomic<uint64_t> batchesFlushed{0};
+    std::atomic<uint64_t> flushFailures{0};
+    std::atomic<uint64_t> linesDropped{0}; // Discarded by the pending limit
+    LatencyHistogram flushLatency; // Per-batch send time, in readTicks() units
+
 private:
     std::string serverURL;
     std::string database;
     std::mutex writeMutex;
+    std::ostream *output;
+    std::string lineBuffer; // Reused encoding buffer, guarded by writeMutex
+
+    // Batching writer state (pending/pendingLines guarded by writeMutex)
+    bool batching = false;
+    bool useHttp = false;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<size_t> pendingBytes{0}; // pending.size(), readable without the lock
+    size_t batchBytes = 0;
+    int flushMs = 1000;
+    std::vector<int> writerCpus; // Empty = not pinned
+    std::string pending;
+    uint64_t pendingLines = 0;
+    std::string flushBuffer;     // Owned by the writer thread
+    void* curlHandle = nullptr;  // CURL*, owned by the writer thread
+    WaitStrategy flushWait;      // Writer waits here for a full batch or stop
+    size_t maxPendingBytes = 0;  // 0 = unbounded
+    OverflowPolicy overflowPolicy = OverflowPolicy::Block;
+    WaitStrategy spaceWait;      // Blocked producers wait here for the writer to take the batch
+    std::thread writerThread;
+
+    void writerLoop();
+    bool makeRoom(std::unique_lock<std::mutex> &lock); // false: drop the new line
+    bool sendBatch(const std::string &batch);
 };
 
-#endif // INFLUX_DB_CLIENT_H
\ No newline at end of file
+#endif // INFLUX_DB_CLIENT_H
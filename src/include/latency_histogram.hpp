@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/latency_histogram.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Pipeline stages timed inside the ingest path.
+ */
+enum class LatencyStage {
+    Frame,   // framing/validation in the monitor before processResponse
+    Parse,   // processResponse entry until all fields are extracted
+    Stats,   // per-stream statistics update
+    Ticker,  // ticker conflation and bar aggregation for graphing
+    Book,    // order book update
+    DbWrite, // storage write
+    Total,   // processResponse entry to exit
+    Count
+};
+
+const char* latencyStageName(LatencyStage stage);
+
+// Raw timestamp: TSC on x86, steady_clock nanoseconds elsewhere
+inline uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Ticks per nanosecond, calibrated once against steady_clock
+double ticksPerNanosecond();
+
+/*
+ * Lock-free log-linear histogram (HDR-style). Values below 2^kSubBucketBits
+ * are exact; above that every power of two is split into 2^kSubBucketBits
+ * linear sub-buckets, which bounds the relative error to ~3%.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kBucketCount = (64 - kSubBucketBits + 1) << kSubBucketBits;
+
+    // Records one value (in ticks); safe from any number of threads
+    void record(uint64_t value) {
+        counts[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t prev = maxValue.load(std::memory_order_relaxed);
+        while(value > prev &&
+              !maxValue.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Value (in ticks) below which the given fraction of samples fall
+    uint64_t percentile(double fraction) const;
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    void reset();
+
+    // Appends "upper_bound_ticks count" pairs for every non-empty bucket
+    void nonEmptyBuckets(std::vector<std::pair<uint64_t, uint64_t>> &out) const;
+
+    static int bucketIndex(uint64_t value) {
+        int msb = 63 - __builtin_clzll(value | 1);
+        if(msb < kSubBucketBits) {
+            return static_cast<int>(value);
+        }
+        int shift = msb - kSubBucketBits;
+        return ((shift + 1) << kSubBucketBits) + static_cast<int>((value >> shift) - kSubBuckets);
+    }
+
+    // Highest value that maps to the given bucket
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> counts{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> maxValue{0};
+};
+
+// Per-stage summary in nanoseconds
+struct LatencySummary {
+    LatencyStage stage;
+    uint64_t count = 0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+};
+
+/*
+ * One histogram per LatencyStage plus a global on/off switch. Recording
+ * is a relaxed load when disabled and two rdtsc reads plus a few relaxed
+ * atomic adds when enabled.
+ */
+class LatencyRecorder {
+public:
+    LatencyRecorder();
+
+    bool enabled() const { return recording.load(std::memory_order_relaxed); }
+    void setEnabled(bool on) { recording.store(on, std::memory_order_relaxed); }
+
+    void record(LatencyStage stage, uint64_t ticks) {
+        histograms[static_cast<size_t>(stage)].record(ticks);
+    }
+
+    const LatencyHistogram& histogram(LatencyStage stage) const {
+        return histograms[static_cast<size_t>(stage)];
+    }
+
+    std::vector<LatencySummary> summarize() const;
+    void reset();
+
+    // Writes the summary table followed by every non-empty bucket; false on I/O error
+    bool dumpToFile(const std::string &path) const;
+
+private:
+    std::atomic<bool> recording{true};
+    std::array<LatencyHistogram, static_cast<size_t>(LatencyStage::Count)> histograms;
+};
+
+/*
+ * Lap timer for a single message. Each lap() records the time since the
+ * previous mark into the given stage; finish() records the whole span.
+ */
+class StageClock {
+public:
+    explicit StageClock(LatencyRecorder &rec)
+        : recorder(rec), active(rec.enabled()) {
+        start = last = active ? readTicks() : 0;
+    }
+
+    void lap(LatencyStage stage) {
+        if(!active) return;
+        uint64_t now = readTicks();
+        recorder.record(stage, now - last);
+        last = now;
+    }
+
+    void finish() {
+        if(!active) return;
+        recorder.record(LatencyStage::Total, readTicks() - start);
+    }
+
+private:
+    LatencyRecorder &recorder;
+    bool active;
+    uint64_t start;
+    uint64_t last;
+};
+
+#endif // LATENCY_HISTOGRAM_HPP
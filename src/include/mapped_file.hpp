@@ -0,0 +1,39 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/mapped_file.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+/*
+ * Read-only mmap of a whole file. Readers get pointers straight into the
+ * page cache instead of copying through iostreams.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps path; on failure returns false and sets error
+    bool open(const std::string &path, std::string &error);
+    void close();
+
+    // Hints the kernel that the mapping will be read front to back
+    void adviseSequential() const;
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+    bool isOpen() const { return opened; }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    bool opened = false;
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/mbo_block_decoder.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MBO_BLOCK_DECODER_HPP
+#define MBO_BLOCK_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "mbo_message.hpp"
+#include "structural_index.hpp"
+
+// One message decoded from a block; offsets are relative to the block start
+struct MboBlockRecord {
+    uint32_t begin;  // Offset of the opening '{'
+    uint32_t end;    // Offset one past the closing '}'
+    bool filtered;   // Rejected by the symbol predicate; msg was not decoded
+    MboMessage msg;
+};
+
+/*
+ * Decodes all MBO messages in a block of NDJSON at once: the structural
+ * index of the whole block is built first, then each object is walked
+ * token by token with value spans taken straight from the index.
+ *
+ * Only flat objects of printable ASCII strings without escapes, JSON
+ * numbers and literals are decoded, and only when parseMboMessage would
+ * accept them with the same result. Anything else (escapes, nesting,
+ * missing fields, type mismatches, malformed text) is left out so callers
+ * can hand that line to the generic parser and get its exact error.
+ *
+ * Fields the message type does not need (MBO_FIELDS_NEEDED) are checked
+ * but not decoded, and keep whatever the record held before. With a symbol
+ * predicate set, an object whose "s" it rejects is marked filtered and not
+ * decoded at all.
+ */
+class MboBlockDecoder {
+public:
+    using SymbolPredicate = std::function<bool(const char* symbol, size_t length)>;
+
+    explicit MboBlockDecoder(SimdLevel level = detectSimdLevel()) : simdLevel(level) {}
+
+    // Objects whose symbol admit returns false for are skipped undecoded (nullptr = decode all)
+    void setSymbolPredicate(SymbolPredicate admit) { admitSymbol = std::move(admit); }
+
+    /*
+     * Decodes the messages in [data, data + size), which must be below
+     * 4 GiB. Decoding stops early after a line whose quotes are unbalanced,
+     * since the string state of the rest of the block is unknown;
+     * consumed() tells where.
+     */
+    size_t decode(const char* data, size_t size);
+
+    // Decoded records of the last block, in input order
+    size_t size() const { return count; }
+    const MboBlockRecord &operator[](size_t i) const { return records[i]; }
+
+    // Bytes of the last block covered by decode(), always a whole number of lines
+    size_t consumed() const { return consumedBytes; }
+
+    // Structural index of the last block
+    const std::vector<uint32_t> &structuralIndex() const { return index; }
+
+private:
+    SimdLevel simdLevel;
+    SymbolPredicate admitSymbol;
+    std::vector<uint32_t> index;
+    std::vector<MboBlockRecord> records; // Reused across blocks to keep string capacity
+    size_t count = 0;
+    size_t consumedBytes = 0;
+
+    // Decodes the object starting at index[k]; on success k moves past its '}'
+    bool decodeObject(const char* data, size_t &k, MboBlockRecord &rec);
+};
+
+#endif // MBO_BLOCK_DECODER_HPP
@@ -0,0 +1,33 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/mbo_message.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MBO_MESSAGE_HPP
+#define MBO_MESSAGE_HPP
+
+#include <string>
+#include "mbo_type.hpp"
+
+/*
+ * One market-by-order event as delivered by the feed, e.g.
+ * {"type":"oba","s":"AAPL","tm":1700000000000,"q":10,"p":101.25,
+ *  "x":"buy","id":"ID1","a":"BrokerA","mid":"MID1"}
+ */
+struct MboMessage {
+    std::string type;
+    MboType kind = MboType::Unknown; // type decoded from the tag
+    std::string symbol;
+    long long timestamp = 0;
+    int quantity = 0;
+    double price = 0.0;
+    long long priceTicks = 0; // p in 1/PRICE_SCALE units (numeric_parse.hpp)
+    std::string side;
+    std::string orderID;
+    std::string attribution;
+    std::string matchID;
+    std::string newID; // "nid", only present on replaces (obr)
+};
+
+// Parses and validates a raw message; on failure returns false and describes why in error
+bool parseMboMessage(const std::string &response, MboMessage &msg, std::string &error);
+
+#endif // MBO_MESSAGE_HPP
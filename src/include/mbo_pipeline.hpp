@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/mbo_pipeline.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MBO_PIPELINE_HPP
+#define MBO_PIPELINE_HPP
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include "mbo_type.hpp"
+
+/*
+ * Per-type handling of MBO messages, resolved at compile time. Each type
+ * declares the sinks it feeds in MboTypeTraits; the fields it needs follow
+ * from those sinks. Decoders skip the fields a type does not need, and
+ * DataProcessor instantiates one pipeline per type that only touches the
+ * declared sinks.
+ */
+
+// Message fields, one bit each
+enum MboField : uint32_t {
+    MBO_FIELD_TYPE        = 1u << 0,
+    MBO_FIELD_SYMBOL      = 1u << 1,
+    MBO_FIELD_TIMESTAMP   = 1u << 2,
+    MBO_FIELD_QUANTITY    = 1u << 3,
+    MBO_FIELD_PRICE       = 1u << 4,
+    MBO_FIELD_SIDE        = 1u << 5,
+    MBO_FIELD_ORDER_ID    = 1u << 6,
+    MBO_FIELD_ATTRIBUTION = 1u << 7,
+    MBO_FIELD_MATCH_ID    = 1u << 8,
+    MBO_FIELD_NEW_ID      = 1u << 9,
+};
+
+// Fields every message must carry to be accepted, whatever its type
+static constexpr uint32_t MBO_REQUIRED_FIELDS =
+    MBO_FIELD_TYPE | MBO_FIELD_SYMBOL | MBO_FIELD_TIMESTAMP | MBO_FIELD_QUANTITY | MBO_FIELD_PRICE |
+    MBO_FIELD_SIDE | MBO_FIELD_ORDER_ID | MBO_FIELD_ATTRIBUTION | MBO_FIELD_MATCH_ID;
+
+// Consumers of a processed message
+enum MboSink : uint32_t {
+    MBO_SINK_STATS   = 1u << 0, // per-stream message count
+    MBO_SINK_TICKER  = 1u << 1, // price series for the graphs
+    MBO_SINK_STORAGE = 1u << 2, // order_book row
+    MBO_SINK_UNKNOWN = 1u << 3, // unhandled-type counter
+    MBO_SINK_BARS    = 1u << 4, // OHLCV bars of trades
+    MBO_SINK_BOOK    = 1u << 5, // price-level order book
+};
+
+/*
+ * Sinks fed by a message type, and the field its stored row uses as the
+ * order id. Add a specialization when adding a tag to MBO_TYPE_TAGS.
+ */
+template <MboType T>
+struct MboTypeTraits;
+
+// Resting-order events: stored, and their price is plotted
+struct MboQuoteTraits {
+    static constexpr uint32_t sinks = MBO_SINK_STATS | MBO_SINK_TICKER | MBO_SINK_STORAGE;
+    static constexpr uint32_t orderIdField = MBO_FIELD_ORDER_ID;
+};
+
+// Adds: also rest an order in the book
+struct MboAddTraits {
+    static constexpr uint32_t sinks = MboQuoteTraits::sinks | MBO_SINK_BOOK;
+    static constexpr uint32_t orderIdField = MBO_FIELD_ORDER_ID;
+};
+
+// Fills: also traded volume, so they build the bars, and shrink the order
+struct MboFillTraits {
+    static constexpr uint32_t sinks = MboQuoteTraits::sinks | MBO_SINK_BARS | MBO_SINK_BOOK;
+    static constexpr uint32_t orderIdField = MBO_FIELD_ORDER_ID;
+};
+
+// Removals: stored and taken off the book, but they do not move the plotted price
+struct MboRemovalTraits {
+    static constexpr uint32_t sinks = MBO_SINK_STATS | MBO_SINK_STORAGE | MBO_SINK_BOOK;
+    static constexpr uint32_t orderIdField = MBO_FIELD_ORDER_ID;
+};
+
+template <> struct MboTypeTraits<MboType::Oba> : MboAddTraits {};
+template <> struct MboTypeTraits<MboType::Obf> : MboFillTraits {};
+template <> struct MboTypeTraits<MboType::Obc> : MboRemovalTraits {};
+template <> struct MboTypeTraits<MboType::Obd> : MboRemovalTraits {};
+template <> struct MboTypeTraits<MboType::Obb> : MboQuoteTraits {};
+template <> struct MboTypeTraits<MboType::Obr> {
+    static constexpr uint32_t sinks = MBO_SINK_STATS | MBO_SINK_TICKER | MBO_SINK_STORAGE | MBO_SINK_BOOK;
+    static constexpr uint32_t orderIdField = MBO_FIELD_NEW_ID;
+};
+template <> struct MboTypeTraits<MboType::Unknown> {
+    static constexpr uint32_t sinks = MBO_SINK_STATS | MBO_SINK_UNKNOWN;
+    static constexpr uint32_t orderIdField = 0;
+};
+
+// Fields a type's sinks read
+template <MboType T>
+constexpr uint32_t mboFieldsNeeded() {
+    using Traits = MboTypeTraits<T>;
+    uint32_t fields = MBO_FIELD_TYPE;
+    if(Traits::sinks & MBO_SINK_TICKER) {
+        fields |= MBO_FIELD_SYMBOL | MBO_FIELD_PRICE;
+    }
+    if(Traits::sinks & MBO_SINK_BARS) {
+        fields |= MBO_FIELD_SYMBOL | MBO_FIELD_PRICE | MBO_FIELD_TIMESTAMP | MBO_FIELD_QUANTITY;
+    }
+    if(Traits::sinks & MBO_SINK_BOOK) {
+        // A replace moves the order under id to nid
+        fields |= MBO_FIELD_SYMBOL | MBO_FIELD_PRICE | MBO_FIELD_QUANTITY | MBO_FIELD_SIDE | MBO_FIELD_ORDER_ID |
+                  Traits::orderIdField;
+    }
+    if(Traits::sinks & MBO_SINK_STORAGE) {
+        fields |= MBO_FIELD_SYMBOL | MBO_FIELD_PRICE | MBO_FIELD_TIMESTAMP | MBO_FIELD_QUANTITY |
+                  MBO_FIELD_SIDE | MBO_FIELD_ATTRIBUTION | MBO_FIELD_MATCH_ID | Traits::orderIdField;
+    }
+    return fields;
+}
+
+template <size_t... I>
+constexpr std::array<uint32_t, MBO_TYPE_COUNT> makeMboFieldsTable(std::index_sequence<I...>) {
+    return {{mboFieldsNeeded<static_cast<MboType>(I)>()...}};
+}
+
+// mboFieldsNeeded for every type, indexed by MboType
+static constexpr std::array<uint32_t, MBO_TYPE_COUNT> MBO_FIELDS_NEEDED =
+    makeMboFieldsTable(std::make_index_sequence<MBO_TYPE_COUNT>());
+
+#endif // MBO_PIPELINE_HPP
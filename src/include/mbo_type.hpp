@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/mbo_type.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MBO_TYPE_HPP
+#define MBO_TYPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * MBO message types, decoded once at parse time from the 3-byte "type"
+ * tag. Handlers are looked up by this value, so it doubles as a table index.
+ */
+enum class MboType : uint8_t {
+    Oba,     // order added
+    Obf,     // order filled
+    Obc,     // order cancelled
+    Obd,
+    Obb,
+    Obr,     // order replaced ("nid" carries the new id)
+    Unknown  // any other tag
+};
+
+static constexpr size_t MBO_TYPE_COUNT = static_cast<size_t>(MboType::Unknown) + 1;
+
+struct MboTypeTag {
+    const char* tag;
+    MboType type;
+};
+
+static constexpr MboTypeTag MBO_TYPE_TAGS[] = {
+    {"oba", MboType::Oba}, {"obf", MboType::Obf}, {"obc", MboType::Obc},
+    {"obd", MboType::Obd}, {"obb", MboType::Obb}, {"obr", MboType::Obr},
+};
+
+// Tag text of a type ("unknown" for Unknown)
+const char* mboTypeName(MboType type);
+
+constexpr uint32_t packMboTag(const char* tag) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(tag[0])) |
+           static_cast<uint32_t>(static_cast<uint8_t>(tag[1])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(tag[2])) << 16;
+}
+
+/*
+ * Perfect hash of the known tags into 8 slots: the top 3 bits of the
+ * packed tag times an odd multiplier. The multiplier is searched for at
+ * compile time, so adding a tag to MBO_TYPE_TAGS only needs a rebuild.
+ */
+static constexpr unsigned MBO_TAG_SLOT_BITS = 3;
+static constexpr size_t MBO_TAG_SLOTS = size_t(1) << MBO_TAG_SLOT_BITS;
+
+constexpr uint32_t mboTagSlot(uint32_t packed, uint32_t multiplier) {
+    return (packed * multiplier) >> (32 - MBO_TAG_SLOT_BITS);
+}
+
+constexpr uint32_t findMboTagMultiplier() {
+    for(uint32_t multiplier = 1; multiplier < (1u << 20); multiplier += 2) {
+        bool used[MBO_TAG_SLOTS] = {};
+        bool collision = false;
+        for(const MboTypeTag &t : MBO_TYPE_TAGS) {
+            uint32_t slot = mboTagSlot(packMboTag(t.tag), multiplier);
+            collision = collision || used[slot];
+            used[slot] = true;
+        }
+        if(!collision) return multiplier;
+    }
+    return 0;
+}
+
+static constexpr uint32_t MBO_TAG_MULTIPLIER = findMboTagMultiplier();
+static_assert(MBO_TAG_MULTIPLIER != 0, "no collision-free multiplier for MBO_TYPE_TAGS");
+
+struct MboTagTable {
+    uint32_t packed[MBO_TAG_SLOTS];
+    MboType type[MBO_TAG_SLOTS];
+};
+
+constexpr MboTagTable buildMboTagTable() {
+    MboTagTable table{};
+    for(size_t i = 0; i < MBO_TAG_SLOTS; ++i) {
+        table.packed[i] = 0;
+        table.type[i] = MboType::Unknown;
+    }
+    for(const MboTypeTag &t : MBO_TYPE_TAGS) {
+        uint32_t slot = mboTagSlot(packMboTag(t.tag), MBO_TAG_MULTIPLIER);
+        table.packed[slot] = packMboTag(t.tag);
+        table.type[slot] = t.type;
+    }
+    return table;
+}
+
+static constexpr MboTagTable MBO_TAG_TABLE = buildMboTagTable();
+
+// One multiply, one load and one compare; anything but a known 3-byte tag is Unknown
+inline MboType mboTypeFromTag(const char* tag, size_t length) {
+    if(length != 3) return MboType::Unknown;
+    uint32_t packed = packMboTag(tag);
+    uint32_t slot = mboTagSlot(packed, MBO_TAG_MULTIPLIER);
+    return MBO_TAG_TABLE.packed[slot] == packed ? MBO_TAG_TABLE.type[slot] : MboType::Unknown;
+}
+
+#endif // MBO_TYPE_HPP
@@ -0,0 +1,30 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/message_framer.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MESSAGE_FRAMER_HPP
+#define MESSAGE_FRAMER_HPP
+
+#include <string>
+
+/*
+ * Splits a byte stream into flat JSON objects ("{...}"). Input may arrive
+ * in arbitrary pieces; consumed bytes are compacted lazily instead of
+ * erasing the front of the buffer for every message.
+ */
+class MessageFramer {
+public:
+    // Adds raw input to the buffer
+    void append(const std::string &data);
+
+    // Extracts (and consumes) the next complete object; false if none is buffered yet
+    bool next(std::string &message);
+
+    // Unconsumed bytes
+    std::string pending() const { return buffer.substr(readPos); }
+
+private:
+    std::string buffer;
+    size_t readPos = 0;
+};
+
+#endif // MESSAGE_FRAMER_HPP
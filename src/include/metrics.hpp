@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/metrics.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "latency_histogram.hpp"
+
+/*
+ * Process-wide metrics in Prometheus text exposition format.
+ *
+ * Hot paths hold a reference obtained once at startup and only touch
+ * relaxed atomics. Existing counters (e.g. CoreData::requestCount) are
+ * exposed through callbacks that run at scrape time; callbacks must only
+ * read atomics so a scrape never takes an ingest-path lock. The registry
+ * mutex is only taken by registration and scrapes.
+ */
+
+enum class MetricType {
+    Counter,
+    Gauge,
+    Histogram
+};
+
+class MetricCounter {
+public:
+    void inc(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+class MetricGauge {
+public:
+    void set(double v) { value.store(v, std::memory_order_relaxed); }
+    void add(double v) { value.fetch_add(v, std::memory_order_relaxed); }
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value{0.0};
+};
+
+/*
+ * Histogram over raw integer samples (e.g. rdtsc ticks) backed by a
+ * LatencyHistogram; unitSeconds converts one sample unit to seconds.
+ */
+class MetricHistogram {
+public:
+    explicit MetricHistogram(double unitSeconds) : scale(unitSeconds) {}
+
+    void record(uint64_t value) { hist.record(value); }
+    const LatencyHistogram& data() const { return hist; }
+    double unitSeconds() const { return scale; }
+
+private:
+    LatencyHistogram hist;
+    double scale;
+};
+
+// Seconds per readTicks() unit, for tick-based histograms
+double secondsPerTick();
+
+// Formats one label pair, escaping the value: key="value"
+std::string metricLabel(const std::string &key, const std::string &value);
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    // Owned metrics; repeated calls with the same name and labels return the same object
+    MetricCounter& counter(const std::string &name, const std::string &help, const std::string &labels = "");
+    MetricGauge& gauge(const std::string &name, const std::string &help, const std::string &labels = "");
+    MetricHistogram& histogram(const std::string &name, const std::string &help,
+                               const std::string &labels, double unitSeconds);
+
+    // Values read at scrape time; re-registering the same name and labels replaces the source
+    void counterCallback(const std::string &name, const std::string &help,
+                         const std::string &labels, std::function<double()> read);
+    void gaugeCallback(const std::string &name, const std::string &help,
+                       const std::string &labels, std::function<double()> read);
+    void histogramView(const std::string &name, const std::string &help, const std::string &labels,
+                       const LatencyHistogram* hist, double unitSeconds);
+
+    // Renders every metric in Prometheus text format 0.0.4
+    std::string render() const;
+
+private:
+    struct Series {
+        std::string labels;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+        std::function<double()> read;
+        const LatencyHistogram* view = nullptr;
+        double unitSeconds = 1.0;
+    };
+
+    struct Family {
+        std::string help;
+        MetricType type;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+    Series& series(const std::string &name, const std::string &help,
+                   MetricType type, const std::string &labels);
+
+    mutable std::mutex mutex;
+    std::map<std::string, Family> families;
+};
+
+#endif // METRICS_HPP
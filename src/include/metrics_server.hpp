@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/metrics_server.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef METRICS_SERVER_HPP
+#define METRICS_SERVER_HPP
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/*
+ * Minimal HTTP listener serving MetricsRegistry::render() on GET /metrics.
+ * One connection at a time on its own thread; meant for a local scraper,
+ * so bind to 127.0.0.1 unless the port is firewalled.
+ */
+class MetricsServer {
+public:
+    MetricsServer();
+    ~MetricsServer();
+
+    // Binds and starts serving; false (with a message on stderr) if the socket can't be set up
+    bool start(const std::string &bindAddress, int port);
+
+    // Stops the listener thread and closes the socket
+    void stop();
+
+private:
+    int listenFd;
+    std::atomic<bool> stopRequested{false};
+    std::thread serverThread;
+
+    void serve();
+    void handleClient(int clientFd);
+};
+
+#endif // METRICS_SERVER_HPP
@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/numeric_parse.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef NUMERIC_PARSE_HPP
+#define NUMERIC_PARSE_HPP
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Decoders for the numeric MBO fields. Each takes the exact text of one
+ * JSON number (no surrounding whitespace), rejects anything outside the
+ * JSON grammar and returns the same value std::from_chars would.
+ */
+
+// Fixed-point price units per 1.0; prices are also carried as integer ticks of 1e-8
+static const long long PRICE_SCALE = 100000000;
+
+// Nearest tick count of a binary price; false if it does not fit in a long long
+inline bool priceToTicks(double price, long long &ticks) {
+    double scaled = price * static_cast<double>(PRICE_SCALE);
+    if(!(scaled >= -0x1p63 && scaled < 0x1p63)) return false;
+    ticks = std::llround(scaled);
+    return true;
+}
+
+// True if all 8 bytes of a little-endian chunk are ASCII digits
+inline bool isEightDigits(uint64_t chunk) {
+    return (((chunk + 0x4646464646464646ULL) | (chunk - 0x3030303030303030ULL)) & 0x8080808080808080ULL) == 0;
+}
+
+// Value of 8 ASCII digits loaded little-endian, with three multiplies (SWAR)
+inline uint32_t eightDigitsValue(uint64_t chunk) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL; // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL; // 1 + (10000 << 32)
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+
+/*
+ * Accumulates the run of digits at p into value, 8 at a time while
+ * possible. Returns the first non-digit. value wraps past 19 digits, so
+ * callers bound the digit count.
+ */
+inline const char* accumulateDigits(const char* p, const char* end, uint64_t &value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while(end - p >= 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, p, sizeof(chunk));
+        if(!isEightDigits(chunk)) break;
+        value = value * 100000000ULL + eightDigitsValue(chunk);
+        p += 8;
+    }
+#endif
+    while(p < end && static_cast<unsigned char>(*p - '0') <= 9) {
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    return p;
+}
+
+// JSON integer ("-"? and no leading zeros) into a long long; false if invalid or out of range
+inline bool parseJsonInt64(const char* p, const char* end, long long &out) {
+    bool negative = p < end && *p == '-';
+    if(negative) ++p;
+    const char* digits = p;
+    uint64_t value = 0;
+    p = accumulateDigits(p, end, value);
+    size_t count = static_cast<size_t>(p - digits);
+    if(p != end || count == 0 || count > 19 || (*digits == '0' && count > 1)) return false;
+    if(value > static_cast<uint64_t>(INT64_MAX) + (negative ? 1 : 0)) return false;
+    out = negative ? static_cast<long long>(0 - value) : static_cast<long long>(value);
+    return true;
+}
+
+// As parseJsonInt64, for values that fit in an int
+inline bool parseJsonInt32(const char* p, const char* end, int &out) {
+    long long value;
+    if(!parseJsonInt64(p, end, value) || value < INT32_MIN || value > INT32_MAX) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+/*
+ * JSON number into a double and fixed-point ticks of 1/PRICE_SCALE.
+ *
+ * Plain decimals of up to 19 significant digits are read as an integer
+ * mantissa and a count of fraction digits. Ticks then follow exactly, and
+ * the double is one correctly rounded division by an exact power of ten
+ * (Clinger's fast path) while the mantissa fits in 53 bits. Exponents and
+ * longer mantissas take std::from_chars for the double. Prices whose
+ * ticks do not fit in a long long are rejected.
+ */
+inline bool parseJsonPrice(const char* begin, const char* end, double &price, long long &ticks) {
+    static const double POW10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19
+    };
+    static const long long TICKS_POW10[] = {
+        100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1
+    };
+
+    const char* p = begin;
+    bool negative = p < end && *p == '-';
+    if(negative) ++p;
+    const char* intDigits = p;
+    uint64_t mantissa = 0;
+    p = accumulateDigits(p, end, mantissa);
+    size_t intCount = static_cast<size_t>(p - intDigits);
+    if(intCount == 0 || (*intDigits == '0' && intCount > 1)) return false;
+
+    size_t fracCount = 0;
+    if(p < end && *p == '.') {
+        const char* fracDigits = ++p;
+        p = accumulateDigits(p, end, mantissa);
+        fracCount = static_cast<size_t>(p - fracDigits);
+        if(fracCount == 0) return false;
+    }
+
+    if(p != end || intCount + fracCount > 19) {
+        // Exponent or long mantissa: check the rest of the grammar, then the slow path
+        if(p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            if(p < end && (*p == '+' || *p == '-')) ++p;
+            const char* expDigits = p;
+            while(p < end && static_cast<unsigned char>(*p - '0') <= 9) ++p;
+            if(p == expDigits) return false;
+        }
+        if(p != end) return false;
+        auto res = std::from_chars(begin, end, price);
+        if(res.ec != std::errc() || res.ptr != end) return false;
+        return priceToTicks(price, ticks);
+    }
+
+    if(mantissa <= (1ULL << 53)) {
+        price = static_cast<double>(mantissa) / POW10[fracCount];
+        if(negative) price = -price;
+    } else {
+        std::from_chars(begin, end, price);
+    }
+    long long scaled;
+    if(fracCount <= 8 && mantissa <= static_cast<uint64_t>(INT64_MAX) &&
+       !__builtin_mul_overflow(static_cast<long long>(mantissa), TICKS_POW10[fracCount], &scaled)) {
+        ticks = negative ? -scaled : scaled;
+        return true;
+    }
+    return priceToTicks(price, ticks);
+}
+
+#endif // NUMERIC_PARSE_HPP
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/order_book.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef ORDER_BOOK_HPP
+#define ORDER_BOOK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Ids per symbol whose events arrived before their add; past it they are forgotten
+const size_t BOOK_EARLY_LIMIT = 65536;
+
+// Resting size at one price
+struct BookLevel {
+    long long priceTicks = 0; // 1/PRICE_SCALE units (numeric_parse.hpp)
+    long long quantity = 0;
+    int orders = 0;
+};
+
+// Best levels of one symbol's book, best first on each side
+struct BookDepth {
+    uint64_t version = 0; // OrderBook::version when copied
+    std::vector<BookLevel> bids;
+    std::vector<BookLevel> asks;
+};
+
+/*
+ * Per-symbol price-level book rebuilt from the MBO events: adds rest an
+ * order, replaces move it to a new price and size under a new id, fills
+ * shrink it and cancels or deletes remove it. Each level keeps its total
+ * size and order count, so an event costs one hash lookup and one level
+ * update under the symbol's lock. The monitors process messages in
+ * parallel, so a fill, cancel or replace can reach the book before the add
+ * of its order. Such events are counted in unmatched and remembered (up to
+ * BOOK_EARLY_LIMIT ids per symbol), and the late add rests only what is
+ * left of the order.
+ */
+class OrderBook {
+public:
+    OrderBook();
+    ~OrderBook();
+
+    // Writer side; any thread
+    void add(const std::string &symbol, const std::string &orderID, bool buy, long long priceTicks, long long quantity);
+    void replace(const std::string &symbol, const std::string &orderID, const std::string &newID, bool buy,
+                 long long priceTicks, long long quantity);
+    void fill(const std::string &symbol, const std::string &orderID, long long quantity);
+    void remove(const std::string &symbol, const std::string &orderID);
+
+    // Bumped by every change to the symbol's book; 0 = no events yet
+    uint64_t version(const std::string &symbol) const;
+
+    // Refreshes out with up to levels best levels per side unless it already
+    // holds that version; true if out changed
+    bool depth(const std::string &symbol, size_t levels, BookDepth &out) const;
+
+    // Empties every book; call while no writer runs
+    void clear();
+
+    void setEnabled(bool on) { active.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+    std::atomic<long long> liveOrders{0};
+    std::atomic<uint64_t> unmatched{0};
+
+private:
+    struct Order {
+        long long priceTicks = 0;
+        long long quantity = 0;
+        bool buy = false;
+    };
+
+    struct Level {
+        long long quantity = 0;
+        int orders = 0;
+    };
+
+    struct SymbolBook {
+        mutable std::mutex mutex; // Guards orders, early, bids and asks
+        std::unordered_map<std::string, Order> orders;
+        std::unordered_map<std::string, long long> early; // Id -> quantity consumed before its add (-1 = all)
+        std::map<long long, Level, std::greater<long long>> bids; // Best (highest) first
+        std::map<long long, Level> asks;                          // Best (lowest) first
+        std::atomic<uint64_t> version{0};
+
+        void rest(const Order &order);
+        void unrest(const Order &order, long long quantity, bool last);
+        void consumeEarly(const std::string &orderID, long long quantity);
+    };
+
+    std::atomic<bool> active{true};
+    mutable std::shared_mutex symbolsMutex; // Guards symbols (not their books)
+    std::unordered_map<std::string, std::unique_ptr<SymbolBook>> symbols;
+
+    SymbolBook* find(const std::string &symbol) const;
+    SymbolBook* findOrCreate(const std::string &symbol);
+};
+
+#endif // ORDER_BOOK_HPP
@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/pipeline.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "core_data.hpp"
+
+/*
+ * Lifecycle of the monitor threads, shared by the GTK front end and
+ * headless entry points.
+ */
+
+// Resets counters and starts the monitors for config.dataMode; false if nothing was started
+bool startMonitors(CoreData* core);
+
+/*
+ * Stops and joins the monitors, then writes the configured latency/trace
+ * dumps. With joinTimeoutMs >= 0, monitors that have not returned by then
+ * (e.g. blocked reading stdin) are detached and false is returned; core
+ * must then outlive the process.
+ */
+bool stopMonitors(CoreData* core, int joinTimeoutMs = -1);
+
+/*
+ * Plans thread placement from the sysfs topology when config.threadPinning
+ * is set, reports it on stderr and pins the calling (main) thread. Call
+ * before starting any other thread so they inherit the main thread's CPUs.
+ * dbWriter says whether this binary starts the batching storage writer.
+ */
+void planThreadPlacement(CoreData* core, bool dbWriter);
+
+// Exposes the monitor, processor and storage counters of core in MetricsRegistry
+void registerPipelineMetrics(CoreData* core);
+
+#endif // PIPELINE_HPP
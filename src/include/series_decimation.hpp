@@ -0,0 +1,29 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/series_decimation.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef SERIES_DECIMATION_HPP
+#define SERIES_DECIMATION_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/*
+ * Min/max decimation for line plots: splits values into `buckets` equal
+ * ranges and keeps each range's minimum and maximum in their original
+ * order, so spikes survive while at most 2 * buckets points are stroked.
+ * Series that are already small enough are copied unchanged.
+ */
+void decimateMinMax(const std::vector<double> &values, size_t buckets, std::vector<double> &out);
+
+/*
+ * Visible-window variant for timestamped samples (times non-decreasing):
+ * binary-searches the samples inside [t0, t1], plus one neighbour on each
+ * side so lines reach the edges, and keeps the minimum and maximum of each
+ * of `columns` equal time slices in their original order. Writes
+ * (time, value) pairs; only the visible samples are read.
+ */
+void decimateWindow(const std::vector<double> &times, const std::vector<double> &values,
+                    double t0, double t1, size_t columns, std::vector<std::pair<double, double>> &out);
+
+#endif // SERIES_DECIMATION_HPP
@@ -0,0 +1,42 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/structural_index.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef STRUCTURAL_INDEX_HPP
+#define STRUCTURAL_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Vectorized first pass over a block of JSON text (simdjson-style stage 1).
+ *
+ * The block is classified 64 bytes at a time into bitmasks of quotes,
+ * backslashes and structural characters. Escaped quotes are removed with
+ * carry-propagating bit arithmetic, a prefix XOR over the remaining quotes
+ * yields the in-string mask, and the offsets of every unescaped quote plus
+ * every { } [ ] : , outside strings are appended to the index. The
+ * classification step has AVX2, SSE4.2 and scalar versions; the best one
+ * the CPU supports is picked at runtime.
+ */
+
+enum class SimdLevel {
+    Scalar,
+    SSE42,
+    AVX2
+};
+
+const char* simdLevelName(SimdLevel level);
+
+// Best level supported by this CPU (checked once)
+SimdLevel detectSimdLevel();
+
+/*
+ * Appends the block offsets of all structural characters in
+ * [data, data + size) to out (which is cleared first). size must be below
+ * 4 GiB. Returns false if the block ends inside a string.
+ */
+bool buildStructuralIndex(const char* data, size_t size, std::vector<uint32_t> &out,
+                          SimdLevel level = detectSimdLevel());
+
+#endif // STRUCTURAL_INDEX_HPP
@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/symbol_filter.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef SYMBOL_FILTER_HPP
+#define SYMBOL_FILTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * Set of subscribed symbols checked at ingress, before a message is
+ * validated or parsed. Lookups go through an immutable perfect-hash table
+ * that writers rebuild on every change; each reader thread keeps its own
+ * reference and only reloads it when the version moves, so the hot path
+ * takes no lock.
+ */
+class SymbolFilter {
+public:
+    SymbolFilter();
+    ~SymbolFilter();
+
+    // Messages are only dropped while enabled; the set can be edited either way
+    void setEnabled(bool on) { active.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+    // Replaces, extends or shrinks the set
+    void assign(const std::vector<std::string> &symbols);
+    void add(const std::string &symbol);
+    void remove(const std::string &symbol);
+
+    std::vector<std::string> symbols() const;
+
+    // True if symbol is in the set; an empty symbol never is
+    bool contains(const char* symbol, size_t length) const;
+
+    struct Table;
+
+private:
+    const uint64_t id;                      // Tells filters apart in the reader caches
+    std::atomic<bool> active{false};
+    std::atomic<uint64_t> version{0};       // Bumped after every rebuild
+    mutable std::mutex mutex;               // Guards members and table
+    std::set<std::string> members;
+    std::shared_ptr<const Table> table;
+
+    void rebuild();
+};
+
+/*
+ * Finds the value of the top-level "s" member of a flat JSON object
+ * without parsing it. Returns false when it cannot tell cheaply (no such
+ * member, escapes, nested values before it); such messages are left to
+ * the parser.
+ */
+bool scanSymbolField(const char* data, size_t size, const char* &symbol, size_t &length);
+
+#endif // SYMBOL_FILTER_HPP
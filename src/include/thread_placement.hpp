@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/thread_placement.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef THREAD_PLACEMENT_HPP
+#define THREAD_PLACEMENT_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// One logical CPU as described by /sys/devices/system/cpu/cpuN/topology
+struct CpuInfo {
+    int cpu;
+    int package; // physical_package_id
+    int core;    // core_id, unique within the package; hyperthreads share it
+};
+
+// Parses a sysfs/taskset CPU list such as "0-3,8,10-11"; false if malformed
+bool parseCpuList(const std::string &text, std::vector<int> &cpus);
+
+// Online CPUs the process may run on, in CPU order
+std::vector<CpuInfo> readCpuTopology();
+
+// Restricts the calling thread to cpus; false if the kernel refused
+bool pinCurrentThread(const std::vector<int> &cpus);
+
+enum class ThreadRole {
+    Main,     // GTK or server main thread; threads it starts inherit its CPUs
+    Monitor,  // Ingest reader and processing, one per monitor
+    DbWriter  // Batching storage writer
+};
+
+/*
+ * Maps pipeline threads to CPUs. The first reserveCores physical cores
+ * (all of their hyperthreads) are left to the OS, the main thread and
+ * background threads. Monitors and the storage writer each get a CPU of
+ * their own on the remaining cores, one per physical core before any
+ * hyperthread sibling is used, so two hot threads only share a core when
+ * there are not enough of them.
+ */
+class ThreadPlacement {
+public:
+    /*
+     * Plans for `monitors` monitor threads, plus one storage writer if
+     * dbWriter, over topology, optionally limited to allowedCpus (empty =
+     * all of them). Leaves placement disabled if topology is empty.
+     */
+    void plan(const std::vector<CpuInfo> &topology, const std::vector<int> &allowedCpus,
+              int reserveCores, int monitors, bool dbWriter = true);
+
+    bool enabled() const { return active; }
+
+    // CPUs a thread of this role is pinned to; empty when not pinned
+    std::vector<int> cpusFor(ThreadRole role, int index = 0) const;
+
+    // Pins the calling thread as cpusFor(role, index); no-op when disabled
+    void pin(ThreadRole role, int index = 0) const;
+
+    // One line per thread: role, CPU, core, and any core it has to share
+    void report(std::ostream &out) const;
+
+private:
+    bool active = false;
+    int monitorCount = 0;
+    bool writerPlanned = false;
+    std::vector<CpuInfo> cpus;
+    std::vector<int> reserved; // Main and background threads
+    std::vector<int> hot;      // Monitor i gets hot[i % size], the writer hot[monitors % size]
+
+    int hotCpu(ThreadRole role, int index) const;
+    const CpuInfo* info(int cpu) const;
+};
+
+#endif // THREAD_PLACEMENT_HPP
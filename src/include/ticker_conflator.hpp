@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/ticker_conflator.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef TICKER_CONFLATOR_HPP
+#define TICKER_CONFLATOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Prices one symbol traded at since the last drain
+struct TickerInterval {
+    double low = 0.0;
+    double high = 0.0;
+    double last = 0.0;
+    uint64_t count = 0;    // 0 = no update since the last drain
+    bool lowFirst = true;  // The low came before the high
+
+    void add(double price) {
+        if(count == 0) {
+            low = high = price;
+            lowFirst = true;
+        } else if(price < low) {
+            low = price;
+            lowFirst = false;
+        } else if(price > high) {
+            high = price;
+            lowFirst = true;
+        }
+        last = price;
+        count++;
+    }
+};
+
+/*
+ * Bridge between the processing threads and the UI frame timer. Each
+ * writer thread owns a slot holding two per-symbol interval maps; it folds
+ * every price into the active one, and drain() flips the slot once per
+ * frame and hands out what the other map collected. The slot lock is only
+ * ever shared with the draining thread, once per frame, so writers never
+ * contend with each other, and a drain costs O(writers x symbols) however
+ * many messages arrived.
+ */
+class TickerConflator {
+public:
+    TickerConflator();
+    ~TickerConflator();
+
+    // Writer side; any thread, each gets its own slot on first use
+    void record(const std::string &symbol, double price);
+
+    // Calls fn(symbol, interval) for every symbol updated since the last
+    // drain. Only one thread may drain.
+    template <typename Fn>
+    void drain(Fn fn);
+
+    // Drops pending intervals and releases every slot; call while no writer runs
+    void reset();
+
+private:
+    struct Slot {
+        std::mutex mutex; // Guards active; held by the writer while it updates maps[active]
+        int active = 0;
+        std::unordered_map<std::string, TickerInterval> maps[2];
+        bool claimed = false;
+    };
+
+    const uint64_t id;                      // Tells conflators apart in the writer caches
+    std::atomic<uint64_t> generation{0};    // Bumped by reset() so writers claim again
+    std::mutex slotsMutex;                  // Guards slots and Slot::claimed
+    std::vector<std::unique_ptr<Slot>> slots;
+
+    Slot* writerSlot();
+};
+
+template <typename Fn>
+void TickerConflator::drain(Fn fn) {
+    std::vector<Slot*> current;
+    {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        for(const auto &slot : slots) current.push_back(slot.get());
+    }
+    for(Slot* slot : current) {
+        int full;
+        {
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            full = slot->active;
+            slot->active ^= 1;
+        }
+        // Writers only touch maps[active], so this one is ours until the next flip
+        for(auto &kv : slot->maps[full]) {
+            if(kv.second.count == 0) continue;
+            fn(kv.first, kv.second);
+            kv.second.count = 0; // Keep the node so the symbol costs no allocation next time
+        }
+    }
+}
+
+#endif // TICKER_CONFLATOR_HPP
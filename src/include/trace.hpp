@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/trace.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <string>
+
+/*
+ * Scoped trace zones exported as Chrome trace JSON (chrome://tracing,
+ * ui.perfetto.dev). Build with -DHF_TRACE=ON to enable; otherwise every
+ * macro and function below compiles to nothing.
+ *
+ *   HF_TRACE_SCOPE("processResponse");   // zone until end of scope
+ *   HF_TRACE_THREAD_NAME("gtk-main");    // label the calling thread
+ */
+
+#ifdef HF_ENABLE_TRACE
+
+#include <cstdint>
+#include "latency_histogram.hpp" // readTicks()
+
+// Appends a completed zone to the calling thread's ring buffer
+void traceRecord(const char* name, uint64_t beginTicks, uint64_t endTicks);
+
+// Names the calling thread in the exported trace
+void traceSetThreadName(const char* name);
+
+// Writes every buffered zone of every thread; false on I/O error
+bool traceDumpChromeJson(const std::string &path);
+
+class TraceZone {
+public:
+    explicit TraceZone(const char* zoneName)
+        : name(zoneName), begin(readTicks()) {}
+    ~TraceZone() { traceRecord(name, begin, readTicks()); }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+#define HF_TRACE_CONCAT_INNER(a, b) a##b
+#define HF_TRACE_CONCAT(a, b) HF_TRACE_CONCAT_INNER(a, b)
+#define HF_TRACE_SCOPE(name) TraceZone HF_TRACE_CONCAT(hfTraceZone_, __LINE__)(name)
+#define HF_TRACE_THREAD_NAME(name) traceSetThreadName(name)
+
+#else
+
+inline bool traceDumpChromeJson(const std::string &) { return false; }
+
+#define HF_TRACE_SCOPE(name) ((void)0)
+#define HF_TRACE_THREAD_NAME(name) ((void)0)
+
+#endif // HF_ENABLE_TRACE
+
+#endif // TRACE_HPP
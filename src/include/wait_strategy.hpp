@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// include/wait_strategy.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef WAIT_STRATEGY_HPP
+#define WAIT_STRATEGY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+/*
+ * How a pipeline stage waits for work:
+ *   Spin      - polls with a pause hint; lowest wakeup latency, burns its core
+ *   SpinYield - polls briefly, then yields the core between polls
+ *   Park      - sleeps in the kernel (futex) until notified
+ *   Adaptive  - spins, then yields, then parks the longer the wait lasts
+ */
+enum class WaitMode {
+    Spin,
+    SpinYield,
+    Park,
+    Adaptive
+};
+
+// Config spelling: "spin", "spin_yield", "park", "adaptive"
+const char* waitModeName(WaitMode mode);
+bool parseWaitMode(const std::string &text, WaitMode &mode);
+
+// CPU hint for busy-wait loops
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/*
+ * Wait/notify pair for one consuming stage. The consumer waits for a
+ * condition on state it shares with producers; producers update that
+ * state and call notify(). notify() is one atomic increment unless the
+ * consumer is parked, so busy-polling stages cost producers nothing extra.
+ */
+class WaitStrategy {
+public:
+    explicit WaitStrategy(WaitMode mode = WaitMode::Park) : waitMode(mode) {}
+
+    // Only change while no thread is waiting
+    void setMode(WaitMode mode) { waitMode = mode; }
+    WaitMode mode() const { return waitMode; }
+
+    // Waits until ready() or until timeout passes; returns the last ready()
+    template <typename Ready>
+    bool waitUntil(Ready ready, std::chrono::nanoseconds timeout);
+
+    // Wakes the waiter if it is parked; call after publishing new state
+    void notify() {
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        if(sleepers.load(std::memory_order_seq_cst) != 0) {
+            wake();
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static const uint32_t SPIN_ROUNDS = 2000;  // ~10-50 us of pause loops
+    static const uint32_t YIELD_ROUNDS = 50;   // Adaptive: yields before parking
+
+    WaitMode waitMode;
+    std::atomic<uint32_t> epoch{0};    // Bumped by every notify()
+    std::atomic<uint32_t> sleepers{0}; // Waiters inside park()
+
+    // Sleeps until notify() or the deadline, unless ready() turns true first
+    template <typename Ready>
+    void park(Ready &ready, Clock::time_point deadline);
+
+    // Futex wait while epoch == seen, for at most timeout
+    void sleepOn(uint32_t seen, std::chrono::nanoseconds timeout);
+    void wake();
+};
+
+template <typename Ready>
+void WaitStrategy::park(Ready &ready, Clock::time_point deadline) {
+    uint32_t seen = epoch.load(std::memory_order_seq_cst);
+    sleepers.fetch_add(1, std::memory_order_seq_cst);
+    // Checked after announcing the sleeper, so a notify() in between is not lost
+    if(!ready()) {
+        auto now = Clock::now();
+        if(now < deadline) {
+            sleepOn(seen, deadline - now);
+        }
+    }
+    sleepers.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+template <typename Ready>
+bool WaitStrategy::waitUntil(Ready ready, std::chrono::nanoseconds timeout) {
+    const Clock::time_point deadline = Clock::now() + timeout;
+    for(uint32_t round = 0; ; ++round) {
+        if(ready()) return true;
+        switch(waitMode) {
+            case WaitMode::Spin:
+                cpuRelax();
+                break;
+            case WaitMode::SpinYield:
+                if(round < SPIN_ROUNDS) {
+                    cpuRelax();
+                } else {
+                    std::this_thread::yield();
+                }
+                break;
+            case WaitMode::Park:
+                park(ready, deadline);
+                break;
+            case WaitMode::Adaptive:
+                if(round < SPIN_ROUNDS) {
+                    cpuRelax();
+                } else if(round < SPIN_ROUNDS + YIELD_ROUNDS) {
+                    std::this_thread::yield();
+                } else {
+                    park(ready, deadline);
+                }
+                break;
+        }
+        // Reading the clock is not free; spinning stages only check it now and then
+        if((round & 63) == 0 || waitMode == WaitMode::Park || round >= SPIN_ROUNDS) {
+            if(Clock::now() >= deadline) return ready();
+        }
+    }
+}
+
+#endif // WAIT_STRATEGY_HPP
@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////
+// bar_aggregator.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/bar_aggregator.hpp"
+#include <sstream>
+
+// Intervals aggregated until reset() says otherwise: 1s, 1m, 5m
+static const std::vector<long long> DEFAULT_BAR_INTERVALS = {1000, 60000, 300000};
+
+// Bucket holding tm, rounding towards minus infinity
+static long long bucketOf(long long tm, long long intervalMs) {
+    long long bucket = tm / intervalMs;
+    return (tm % intervalMs < 0) ? bucket - 1 : bucket;
+}
+
+std::string barIntervalName(long long intervalMs) {
+    if(intervalMs % 3600000 == 0) return std::to_string(intervalMs / 3600000) + "h";
+    if(intervalMs % 60000 == 0) return std::to_string(intervalMs / 60000) + "m";
+    if(intervalMs % 1000 == 0) return std::to_string(intervalMs / 1000) + "s";
+    return std::to_string(intervalMs) + "ms";
+}
+
+bool parseBarInterval(const std::string &text, long long &intervalMs) {
+    size_t digits = 0;
+    while(digits < text.size() && text[digits] >= '0' && text[digits] <= '9') digits++;
+    if(digits == 0 || digits > 9) return false;
+    long long count = std::stoll(text.substr(0, digits));
+    std::string unit = text.substr(digits);
+    long long unitMs;
+    if(unit == "ms") {
+        unitMs = 1;
+    } else if(unit == "s") {
+        unitMs = 1000;
+    } else if(unit == "m") {
+        unitMs = 60000;
+    } else if(unit == "h") {
+        unitMs = 3600000;
+    } else {
+        return false;
+    }
+    if(count <= 0) return false;
+    intervalMs = count * unitMs;
+    return true;
+}
+
+bool parseBarIntervals(const std::string &text, std::vector<long long> &intervalsMs) {
+    std::vector<long long> parsed;
+    std::stringstream ss(text);
+    std::string item;
+    while(std::getline(ss, item, ',')) {
+        if(item.empty()) continue;
+        long long ms;
+        if(!parseBarInterval(item, ms)) return false;
+        parsed.push_back(ms);
+    }
+    if(parsed.empty()) return false;
+    intervalsMs = parsed;
+    return true;
+}
+
+BarAggregator::BarAggregator()
+    : intervalsMs(DEFAULT_BAR_INTERVALS)
+{
+}
+
+BarAggregator::~BarAggregator()
+{
+}
+
+BarAggregator::SymbolBars* BarAggregator::find(const std::string &symbol) const {
+    std::shared_lock<std::shared_mutex> lock(symbolsMutex);
+    auto it = symbols.find(symbol);
+    return it == symbols.end() ? nullptr : it->second.get();
+}
+
+BarAggregator::SymbolBars* BarAggregator::findOrCreate(const std::string &symbol) {
+    if(SymbolBars* bars = find(symbol)) return bars;
+
+    std::unique_lock<std::shared_mutex> lock(symbolsMutex);
+    std::unique_ptr<SymbolBars> &bars = symbols[symbol];
+    if(!bars) {
+        bars = std::make_unique<SymbolBars>();
+        bars->rings.resize(intervalsMs.size());
+        for(Ring &ring : bars->rings) ring.slots.resize(BAR_HISTORY);
+    }
+    return bars.get();
+}
+
+void BarAggregator::add(const std::string &symbol, long long tm, double price, int quantity) {
+    SymbolBars* bars = findOrCreate(symbol);
+    std::lock_guard<std::mutex> lock(bars->mutex);
+    for(size_t i = 0; i < intervalsMs.size(); ++i) {
+        Ring &ring = bars->rings[i];
+        long long bucket = bucketOf(tm, intervalsMs[i]);
+        if(ring.started && bucket <= ring.newest - static_cast<long long>(BAR_HISTORY)) {
+            lateTrades.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        long long slot = bucket % static_cast<long long>(BAR_HISTORY);
+        Bar &bar = ring.slots[slot < 0 ? slot + BAR_HISTORY : slot];
+        long long start = bucket * intervalsMs[i];
+        if(bar.start != start) {
+            bar = Bar(); // The slot held a bucket that has left the ring
+            bar.start = start;
+        }
+        bar.add(tm, price, quantity);
+        if(!ring.started || bucket > ring.newest) {
+            ring.newest = bucket;
+            ring.started = true;
+        }
+    }
+    bars->version.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t BarAggregator::version(const std::string &symbol) const {
+    SymbolBars* bars = find(symbol);
+    return bars ? bars->version.load(std::memory_order_acquire) : 0;
+}
+
+bool BarAggregator::snapshot(const std::string &symbol, long long intervalMs, BarSeries &out) const {
+    SymbolBars* bars = find(symbol);
+    uint64_t current = bars ? bars->version.load(std::memory_order_acquire) : 0;
+    if(out.intervalMs == intervalMs && out.version == current) {
+        return false;
+    }
+    out.intervalMs = intervalMs;
+    out.version = current;
+    out.bars.clear();
+    if(!bars) return true;
+
+    size_t index = 0;
+    while(index < intervalsMs.size() && intervalsMs[index] != intervalMs) index++;
+    if(index == intervalsMs.size()) return true;
+
+    std::lock_guard<std::mutex> lock(bars->mutex);
+    out.version = bars->version.load(std::memory_order_relaxed);
+    const Ring &ring = bars->rings[index];
+    if(!ring.started) return true;
+    // Walk the ring's buckets oldest first; slots still holding an older bucket are gaps
+    for(long long bucket = ring.newest - static_cast<long long>(BAR_HISTORY) + 1; bucket <= ring.newest; ++bucket) {
+        long long slot = bucket % static_cast<long long>(BAR_HISTORY);
+        const Bar &bar = ring.slots[slot < 0 ? slot + BAR_HISTORY : slot];
+        if(bar.trades > 0 && bar.start == bucket * intervalMs) out.bars.push_back(bar);
+    }
+    return true;
+}
+
+void BarAggregator::reset(const std::vector<long long> &intervals) {
+    std::unique_lock<std::shared_mutex> lock(symbolsMutex);
+    intervalsMs = intervals.empty() ? DEFAULT_BAR_INTERVALS : intervals;
+    // Symbols stay so their versions keep counting up and readers see the change
+    for(auto &kv : symbols) {
+        std::lock_guard<std::mutex> barsLock(kv.second->mutex);
+        kv.second->rings.assign(intervalsMs.size(), Ring());
+        for(Ring &ring : kv.second->rings) ring.slots.resize(BAR_HISTORY);
+        kv.second->version.fetch_add(1, std::memory_order_release);
+    }
+    lateTrades.store(0);
+}
@@ -0,0 +1,337 @@
+////////////////////////////////////////////////////////////////////////////////
+// book_view.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/book_view.hpp"
+#include "../include/app_data.hpp"
+#include "../include/metrics.hpp"
+#include "../include/numeric_parse.hpp"
+#include "../include/trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Heatmap cell size in widget pixels: one sample wide, one price step high
+static const int column_width = 2;
+static const int row_height = 3;
+
+// Price labels along the right edge of the heatmap
+static const int numPriceLabels = 8;
+
+static const double background[3] = {0.08, 0.08, 0.1};
+static const double bidColor[3] = {0.2, 0.9, 0.4};
+static const double askColor[3] = {0.95, 0.3, 0.25};
+
+// Price in ticks as text, with at least two decimals
+static std::string formatPrice(long long priceTicks) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.8f", priceTicks / static_cast<double>(PRICE_SCALE));
+    std::string price = text;
+    size_t point = price.find('.');
+    while(price.size() > point + 3 && price.back() == '0') price.pop_back();
+    return price;
+}
+
+// Smallest gap between adjacent levels, or gap if that is smaller (0 = none yet)
+static long long smallestGap(const std::vector<BookLevel> &levels, long long gap) {
+    for(size_t i = 1; i < levels.size(); ++i) {
+        long long d = std::llabs(levels[i].priceTicks - levels[i - 1].priceTicks);
+        if(d > 0 && (gap == 0 || d < gap)) gap = d;
+    }
+    return gap;
+}
+
+BookHeatmap::BookHeatmap()
+{
+}
+
+BookHeatmap::~BookHeatmap()
+{
+    if(surface) cairo_surface_destroy(surface);
+}
+
+double BookHeatmap::rowY(long long priceTicks) const {
+    return height / 2.0 - static_cast<double>(priceTicks - anchor) / step * row_height;
+}
+
+void BookHeatmap::clear() {
+    if(surface) cairo_surface_destroy(surface);
+    surface = nullptr;
+    columns.clear();
+    head = count = 0;
+    step = anchor = fullQuantity = 0;
+}
+
+void BookHeatmap::push(const BookDepth &depth, int newWidth, int newHeight, int newScale) {
+    newWidth = std::max(newWidth, column_width);
+    newHeight = std::max(newHeight, 1);
+    bool full = false;
+    if(!surface || newWidth != width || newHeight != height || newScale != scale) {
+        // Keep the newest samples that still fit, oldest first
+        size_t capacity = static_cast<size_t>(newWidth / column_width);
+        std::vector<Column> kept;
+        for(size_t k = count > capacity ? count - capacity : 0; k < count; ++k) {
+            kept.push_back(std::move(columns[(head + columns.size() - count + k) % columns.size()]));
+        }
+        columns.assign(capacity, Column());
+        std::move(kept.begin(), kept.end(), columns.begin());
+        count = kept.size();
+        head = count % capacity;
+
+        if(surface) cairo_surface_destroy(surface);
+        surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, newWidth * newScale, newHeight * newScale);
+        cairo_surface_set_device_scale(surface, newScale, newScale);
+        width = newWidth;
+        height = newHeight;
+        scale = newScale;
+        full = true;
+    }
+
+    size_t slot = head;
+    Column &column = columns[slot];
+    column.bids = depth.bids;
+    column.asks = depth.asks;
+    head = (head + 1) % columns.size();
+    count = std::min(count + 1, columns.size());
+
+    // Row size: the finest price step seen so far
+    long long gap = smallestGap(column.asks, smallestGap(column.bids, 0));
+    if(!column.bids.empty() && !column.asks.empty()) {
+        long long spread = column.asks.front().priceTicks - column.bids.front().priceTicks;
+        if(spread > 0 && (gap == 0 || spread < gap)) gap = spread;
+    }
+    if(gap > 0 && (step == 0 || gap < step)) {
+        step = gap;
+        full = true;
+    }
+    if(step == 0) step = PRICE_SCALE / 100; // One level so far; assume cents
+
+    // Keep the mid price in the middle half of the view
+    long long mid = 0;
+    if(!column.bids.empty() && !column.asks.empty()) {
+        mid = (column.bids.front().priceTicks + column.asks.front().priceTicks) / 2;
+    } else if(!column.bids.empty()) {
+        mid = column.bids.front().priceTicks;
+    } else if(!column.asks.empty()) {
+        mid = column.asks.front().priceTicks;
+    }
+    if(mid > 0 && (anchor == 0 || std::fabs(rowY(mid) - height / 2.0) > height / 4.0)) {
+        anchor = mid / step * step;
+        full = true;
+    }
+
+    // Headroom so the colour scale is not rebuilt on every new maximum
+    long long largest = 0;
+    for(const BookLevel &level : column.bids) largest = std::max(largest, level.quantity);
+    for(const BookLevel &level : column.asks) largest = std::max(largest, level.quantity);
+    if(largest > fullQuantity) {
+        fullQuantity = largest * 2;
+        full = true;
+    }
+
+    if(full) {
+        renderAll();
+    } else {
+        cairo_t* cr = cairo_create(surface);
+        renderColumn(cr, slot);
+        cairo_destroy(cr);
+        cairo_surface_flush(surface);
+    }
+}
+
+void BookHeatmap::renderAll() {
+    static MetricCounter &rebuilds = MetricsRegistry::instance().counter(
+        "hf_book_heatmap_rebuilds_total", "Book heatmaps redrawn in full");
+    rebuilds.inc();
+
+    cairo_t* cr = cairo_create(surface);
+    cairo_set_source_rgb(cr, background[0], background[1], background[2]);
+    cairo_paint(cr);
+    for(size_t k = 0; k < count; ++k) {
+        renderColumn(cr, (head + columns.size() - count + k) % columns.size());
+    }
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+}
+
+void BookHeatmap::renderColumn(cairo_t* cr, size_t slot) {
+    const Column &column = columns[slot];
+    double x = static_cast<double>(slot * column_width);
+    cairo_set_source_rgb(cr, background[0], background[1], background[2]);
+    cairo_rectangle(cr, x, 0, column_width, height);
+    cairo_fill(cr);
+
+    auto paintLevels = [&](const std::vector<BookLevel> &levels, const double* color) {
+        for(const BookLevel &level : levels) {
+            double y = rowY(level.priceTicks);
+            if(y < -row_height || y > height + row_height) continue;
+            // Square root so thin levels stay visible next to large ones
+            double intensity = std::min(1.0, std::sqrt(level.quantity / static_cast<double>(fullQuantity)));
+            cairo_set_source_rgb(cr, background[0] + (color[0] - background[0]) * intensity,
+                                 background[1] + (color[1] - background[1]) * intensity,
+                                 background[2] + (color[2] - background[2]) * intensity);
+            cairo_rectangle(cr, x, y - row_height / 2.0, column_width, row_height);
+            cairo_fill(cr);
+        }
+    };
+    paintLevels(column.bids, bidColor);
+    paintLevels(column.asks, askColor);
+
+    // Best bid and ask
+    cairo_set_source_rgb(cr, 1.0, 0.9, 0.3);
+    if(!column.bids.empty()) cairo_rectangle(cr, x, rowY(column.bids.front().priceTicks), column_width, 1);
+    if(!column.asks.empty()) cairo_rectangle(cr, x, rowY(column.asks.front().priceTicks), column_width, 1);
+    cairo_fill(cr);
+}
+
+void BookHeatmap::draw(cairo_t* cr, int areaWidth, int areaHeight) {
+    cairo_set_source_rgb(cr, background[0], background[1], background[2]);
+    cairo_paint(cr);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 10.0);
+    if(!surface || count == 0 || step == 0) {
+        cairo_set_source_rgb(cr, 0.8, 0.8, 0.8);
+        cairo_move_to(cr, 20, areaHeight / 2);
+        cairo_show_text(cr, "No book data for this symbol yet.");
+        return;
+    }
+
+    // The ring starts after the newest column: [head, end) is older than [0, head)
+    double split = static_cast<double>((columns.size() - head) * column_width);
+    cairo_save(cr);
+    cairo_set_source_surface(cr, surface, -static_cast<double>(head * column_width), 0);
+    cairo_rectangle(cr, 0, 0, split, height);
+    cairo_fill(cr);
+    cairo_set_source_surface(cr, surface, split, 0);
+    cairo_rectangle(cr, split, 0, static_cast<double>(head * column_width), height);
+    cairo_fill(cr);
+    cairo_restore(cr);
+
+    // Price labels along the right edge
+    cairo_set_source_rgb(cr, 0.9, 0.9, 0.9);
+    for(int i = 1; i < numPriceLabels; ++i) {
+        double y = height * i / static_cast<double>(numPriceLabels);
+        long long price = anchor + static_cast<long long>(std::llround((height / 2.0 - y) / row_height * step));
+        cairo_move_to(cr, std::max(0, areaWidth - 70), y + 4);
+        cairo_show_text(cr, formatPrice(price).c_str());
+    }
+}
+
+// Callback function for the "draw" signal of the heatmap
+gboolean book_heatmap_on_draw(GtkWidget* widget, cairo_t* cr, gpointer user_data) {
+    AppData* app = static_cast<AppData*>(user_data);
+    if(app->bookView) {
+        app->bookView->heatmap.draw(cr, gtk_widget_get_allocated_width(widget),
+                                    gtk_widget_get_allocated_height(widget));
+    }
+    return FALSE;
+}
+
+// Callback function for the Book tab symbol combo box (entries follow config.symbols)
+void book_symbol_changed(GtkComboBox* combo, gpointer user_data) {
+    AppData* app = static_cast<AppData*>(user_data);
+    BookView* view = app->bookView.get();
+    int active = gtk_combo_box_get_active(combo);
+    if(!view || active < 0 || active >= static_cast<int>(app->config.symbols.size())) return;
+
+    view->symbol = app->config.symbols[active];
+    view->depth = BookDepth();
+    view->ladderVersion = 0;
+    view->heatmap.clear();
+    if(view->ladderStore) gtk_list_store_clear(view->ladderStore);
+    if(view->heatmapArea) gtk_widget_queue_draw(view->heatmapArea);
+}
+
+// Function to setup the Book tab: symbol selector, price ladder and heatmap
+void setup_book_tab(AppData* app, GtkWidget* notebook) {
+    app->bookView = std::make_shared<BookView>();
+    BookView* view = app->bookView.get();
+    GtkWidget *bookTab = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+
+    GtkWidget *symbolBox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    gtk_box_pack_start(GTK_BOX(symbolBox), gtk_label_new("Symbol"), FALSE, FALSE, 5);
+    GtkWidget *symbolCombo = gtk_combo_box_text_new();
+    for(const auto &sym : app->config.symbols) {
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(symbolCombo), sym.c_str());
+    }
+    g_signal_connect(symbolCombo, "changed", G_CALLBACK(book_symbol_changed), app);
+    gtk_box_pack_start(GTK_BOX(symbolBox), symbolCombo, FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(bookTab), symbolBox, FALSE, FALSE, 5);
+
+    GtkWidget *contentBox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    gtk_box_pack_start(GTK_BOX(bookTab), contentBox, TRUE, TRUE, 5);
+
+    // Ladder: asks above bids, so the best prices meet in the middle
+    GtkWidget *scrolledWindow = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolledWindow),
+                                   GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_widget_set_size_request(scrolledWindow, 380, -1);
+    gtk_box_pack_start(GTK_BOX(contentBox), scrolledWindow, FALSE, FALSE, 5);
+
+    GtkListStore *listStore = gtk_list_store_new(5, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
+                                                 G_TYPE_STRING, G_TYPE_STRING);
+    view->ladderStore = listStore;
+
+    GtkWidget *treeView = gtk_tree_view_new_with_model(GTK_TREE_MODEL(listStore));
+    gtk_container_add(GTK_CONTAINER(scrolledWindow), treeView);
+
+    const char* titles[] = {"Bid orders", "Bid size", "Price", "Ask size", "Ask orders"};
+    for(int i = 0; i < 5; ++i) {
+        GtkCellRenderer *renderer = gtk_cell_renderer_text_new();
+        GtkTreeViewColumn *column = gtk_tree_view_column_new_with_attributes(
+            titles[i], renderer, "text", i, NULL);
+        gtk_tree_view_append_column(GTK_TREE_VIEW(treeView), column);
+    }
+
+    // Heatmap of resting size over time
+    GtkWidget *heatmapArea = gtk_drawing_area_new();
+    g_signal_connect(heatmapArea, "draw", G_CALLBACK(book_heatmap_on_draw), app);
+    gtk_box_pack_start(GTK_BOX(contentBox), heatmapArea, TRUE, TRUE, 5);
+    view->heatmapArea = heatmapArea;
+
+    gtk_combo_box_set_active(GTK_COMBO_BOX(symbolCombo), 0);
+    gtk_widget_show_all(bookTab);
+    gtk_notebook_append_page(GTK_NOTEBOOK(notebook), bookTab, gtk_label_new("Book"));
+}
+
+// Function to sample the book: one heatmap column, and the ladder if the book changed
+gboolean update_book_view(gpointer user_data) {
+    HF_TRACE_SCOPE("update_book_view");
+    AppData* app = static_cast<AppData*>(user_data);
+    BookView* view = app->bookView.get();
+    if(!view || view->symbol.empty()) return TRUE;
+    if(view->heatmapArea && !gtk_widget_get_mapped(view->heatmapArea)) return TRUE; // Tab not shown
+
+    app->book.depth(view->symbol, BOOK_HEATMAP_LEVELS, view->depth);
+    if(view->heatmapArea) {
+        view->heatmap.push(view->depth, gtk_widget_get_allocated_width(view->heatmapArea),
+                           gtk_widget_get_allocated_height(view->heatmapArea),
+                           gtk_widget_get_scale_factor(view->heatmapArea));
+        gtk_widget_queue_draw(view->heatmapArea);
+    }
+
+    if(view->ladderStore && view->depth.version != view->ladderVersion) {
+        view->ladderVersion = view->depth.version;
+        gtk_list_store_clear(view->ladderStore);
+        auto appendRow = [view](const BookLevel &level, bool bid) {
+            std::string orders = std::to_string(level.orders);
+            std::string size = std::to_string(level.quantity);
+            std::string price = formatPrice(level.priceTicks);
+            GtkTreeIter iter;
+            gtk_list_store_append(view->ladderStore, &iter);
+            gtk_list_store_set(view->ladderStore, &iter,
+                               0, bid ? orders.c_str() : "",
+                               1, bid ? size.c_str() : "",
+                               2, price.c_str(),
+                               3, bid ? "" : size.c_str(),
+                               4, bid ? "" : orders.c_str(),
+                               -1);
+        };
+        size_t asks = std::min(view->depth.asks.size(), BOOK_LADDER_LEVELS);
+        for(size_t i = asks; i > 0; --i) appendRow(view->depth.asks[i - 1], false);
+        size_t bids = std::min(view->depth.bids.size(), BOOK_LADDER_LEVELS);
+        for(size_t i = 0; i < bids; ++i) appendRow(view->depth.bids[i], true);
+    }
+
+    return TRUE;
+}
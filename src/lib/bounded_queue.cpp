@@ -0,0 +1,25 @@
+////////////////////////////////////////////////////////////////////////////////
+// bounded_queue.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/bounded_queue.hpp"
+
+const char* overflowPolicyName(OverflowPolicy policy) {
+    switch(policy) {
+        case OverflowPolicy::Block:      return "block";
+        case OverflowPolicy::DropOldest: return "drop_oldest";
+        case OverflowPolicy::DropNewest: return "drop_newest";
+        case OverflowPolicy::Conflate:   return "conflate";
+    }
+    return "block";
+}
+
+bool parseOverflowPolicy(const std::string &text, OverflowPolicy &policy) {
+    for(OverflowPolicy p : {OverflowPolicy::Block, OverflowPolicy::DropOldest,
+                            OverflowPolicy::DropNewest, OverflowPolicy::Conflate}) {
+        if(text == overflowPolicyName(p)) {
+            policy = p;
+            return true;
+        }
+    }
+    return false;
+}
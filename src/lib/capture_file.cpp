@@ -0,0 +1,253 @@
+////////////////////////////////////////////////////////////////////////////////
+// capture_file.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/capture_file.hpp"
+#include "../include/trace.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+static const char CAPTURE_MAGIC[8] = {'H', 'F', 'C', 'A', 'P', '0', '0', '1'};
+static const char CAPTURE_INDEX_MAGIC[8] = {'H', 'F', 'C', 'A', 'P', 'I', 'D', 'X'};
+static const size_t CAPTURE_HEADER_BYTES = 16;
+static const size_t CAPTURE_RECORD_HEADER_BYTES = 12;
+static const size_t CAPTURE_FOOTER_BYTES = 32;
+
+bool isCaptureData(const char* data, size_t size) {
+    return size >= CAPTURE_HEADER_BYTES && std::memcmp(data, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0;
+}
+
+static uint64_t wallClockNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+template <typename T>
+static void appendRaw(std::string &out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static T loadRaw(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CaptureWriter
+////////////////////////////////////////////////////////////////////////////////
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+bool CaptureWriter::open(const std::string &path, size_t flushBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(file != nullptr) return false;
+
+    file = std::fopen(path.c_str(), "wb");
+    if(file == nullptr) {
+        std::cerr << "Failed to open capture file " << path << std::endl;
+        return false;
+    }
+
+    pending.clear();
+    pending.append(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    appendRaw<uint64_t>(pending, wallClockNs());
+    appendedBytes = pending.size();
+    recordCount = 0;
+    index.clear();
+    flushThreshold = flushBytes > 0 ? flushBytes : 1;
+    pending.reserve(flushThreshold * 2);
+    flushBuffer.reserve(flushThreshold * 2);
+    stopRequested = false;
+
+    recordsCaptured = 0;
+    bytesCaptured = 0;
+    writeFailures = 0;
+    writerThread = std::thread(&CaptureWriter::writerLoop, this);
+    capturing = true;
+    return true;
+}
+
+void CaptureWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(file == nullptr) return;
+        capturing = false;
+        stopRequested = true;
+    }
+    flushCv.notify_one();
+    writerThread.join();
+
+    // The writer has drained everything; append the index and footer
+    std::string tail;
+    for(uint64_t offset : index) {
+        appendRaw<uint64_t>(tail, offset);
+    }
+    appendRaw<uint64_t>(tail, appendedBytes);
+    appendRaw<uint64_t>(tail, recordCount);
+    appendRaw<uint32_t>(tail, CAPTURE_INDEX_STRIDE);
+    appendRaw<uint32_t>(tail, 0);
+    tail.append(CAPTURE_INDEX_MAGIC, sizeof(CAPTURE_INDEX_MAGIC));
+    if(!writeOut(tail)) {
+        writeFailures++;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fclose(file);
+    file = nullptr;
+}
+
+void CaptureWriter::record(const char* data, size_t size) {
+    if(!active()) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if(stopRequested) return;
+
+    // Stamped under the lock so receive times are monotonic in file order
+    if(recordCount % CAPTURE_INDEX_STRIDE == 0) {
+        index.push_back(appendedBytes);
+    }
+    appendRaw<uint64_t>(pending, wallClockNs());
+    appendRaw<uint32_t>(pending, static_cast<uint32_t>(size));
+    pending.append(data, size);
+    appendedBytes += CAPTURE_RECORD_HEADER_BYTES + size;
+    recordCount++;
+
+    recordsCaptured.fetch_add(1, std::memory_order_relaxed);
+    bytesCaptured.fetch_add(size, std::memory_order_relaxed);
+    if(pending.size() >= flushThreshold) {
+        flushCv.notify_one();
+    }
+}
+
+void CaptureWriter::writerLoop() {
+    HF_TRACE_THREAD_NAME("capture-writer");
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+        flushCv.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return stopRequested || pending.size() >= flushThreshold;
+        });
+        if(pending.empty()) {
+            if(stopRequested) break;
+            continue;
+        }
+
+        // Swap buffers so producers keep appending while this one is written
+        pending.swap(flushBuffer);
+        lock.unlock();
+        {
+            HF_TRACE_SCOPE("capture_flush");
+            if(!writeOut(flushBuffer)) {
+                writeFailures++;
+            }
+        }
+        flushBuffer.clear();
+        lock.lock();
+    }
+}
+
+bool CaptureWriter::writeOut(const std::string &bytes) {
+    if(std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()) {
+        return false;
+    }
+    return std::fflush(file) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CaptureReader
+////////////////////////////////////////////////////////////////////////////////
+
+bool CaptureReader::open(const std::string &path, std::string &error) {
+    if(!file.open(path, error)) {
+        return false;
+    }
+    const char* base = file.data();
+    size_t size = file.size();
+    if(!isCaptureData(base, size)) {
+        error = path + " is not a capture file";
+        file.close();
+        return false;
+    }
+    captureStartNs = loadRaw<uint64_t>(base + sizeof(CAPTURE_MAGIC));
+    indexData = nullptr;
+    indexEntries = 0;
+
+    // Prefer the footer of a cleanly closed capture
+    const char* footer = nullptr;
+    if(size >= CAPTURE_HEADER_BYTES + CAPTURE_FOOTER_BYTES) {
+        footer = base + size - CAPTURE_FOOTER_BYTES;
+    }
+    if(footer != nullptr && std::memcmp(footer + 24, CAPTURE_INDEX_MAGIC, sizeof(CAPTURE_INDEX_MAGIC)) == 0) {
+        uint64_t indexOffset = loadRaw<uint64_t>(footer);
+        uint64_t records = loadRaw<uint64_t>(footer + 8);
+        uint32_t footerStride = loadRaw<uint32_t>(footer + 16);
+        uint64_t entries = footerStride > 0 ? (records + footerStride - 1) / footerStride : 0;
+        if(footerStride > 0 && indexOffset >= CAPTURE_HEADER_BYTES &&
+           indexOffset + entries * sizeof(uint64_t) + CAPTURE_FOOTER_BYTES == size) {
+            dataEnd = static_cast<size_t>(indexOffset);
+            count = records;
+            stride = footerStride;
+            indexData = base + indexOffset;
+            indexEntries = entries;
+        }
+    }
+
+    if(indexData == nullptr) {
+        // Unterminated capture: count whole records, ignore a truncated tail
+        dataEnd = size;
+        count = 0;
+        CaptureRecord rec;
+        size_t offset = CAPTURE_HEADER_BYTES, nextOffset;
+        while(recordAt(offset, rec, nextOffset)) {
+            count++;
+            offset = nextOffset;
+        }
+        dataEnd = offset;
+    }
+
+    file.adviseSequential();
+    cursor = CAPTURE_HEADER_BYTES;
+    return true;
+}
+
+bool CaptureReader::recordAt(size_t offset, CaptureRecord &out, size_t &nextOffset) const {
+    if(offset + CAPTURE_RECORD_HEADER_BYTES > dataEnd) return false;
+    const char* p = file.data() + offset;
+    out.receiveNs = loadRaw<uint64_t>(p);
+    out.size = loadRaw<uint32_t>(p + 8);
+    if(offset + CAPTURE_RECORD_HEADER_BYTES + out.size > dataEnd) return false;
+    out.data = p + CAPTURE_RECORD_HEADER_BYTES;
+    nextOffset = offset + CAPTURE_RECORD_HEADER_BYTES + out.size;
+    return true;
+}
+
+bool CaptureReader::seek(uint64_t n) {
+    if(n > count) return false;
+
+    // Jump to the closest indexed record at or before n, then walk forward
+    uint64_t current = 0;
+    size_t offset = CAPTURE_HEADER_BYTES;
+    if(indexData != nullptr && n / stride < indexEntries) {
+        current = (n / stride) * stride;
+        offset = static_cast<size_t>(loadRaw<uint64_t>(indexData + (n / stride) * sizeof(uint64_t)));
+    }
+    CaptureRecord rec;
+    size_t nextOffset;
+    while(current < n) {
+        if(!recordAt(offset, rec, nextOffset)) return false;
+        offset = nextOffset;
+        current++;
+    }
+    cursor = offset;
+    return true;
+}
+
+bool CaptureReader::next(CaptureRecord &out) {
+    size_t nextOffset;
+    if(!recordAt(cursor, out, nextOffset)) return false;
+    cursor = nextOffset;
+    return true;
+}
@@ -2,9 +2,19 @@
 // config.cpp
 ////////////////////////////////////////////////////////////////////////////////
 #include "../include/config.hpp"
+#include "../include/bar_aggregator.hpp"
 #include <fstream>
+#include <iostream>
 #include <sstream>
 
+const char* dataModeName(DataMode mode) {
+    switch(mode) {
+        case DataMode::DEV:    return "DEV";
+        case DataMode::REAL:   return "REAL";
+        case DataMode::REPLAY: return "REPLAY";
+    }
+    return "DEV";
+}
 
 Config loadConfig(const std::string &filename) {
     Config cfg;
@@ -13,7 +23,30 @@ Config loadConfig(const std::string &filename) {
     cfg.influxDB    = "market_data_dev";
     cfg.totalCores  = 8;
     cfg.reserveCores= 1;
+    cfg.threadPinning = false;
     cfg.dataMode    = DataMode::DEV;
+    cfg.symbolFilter = false;
+    cfg.latencyRecording = true;
+    cfg.latencyDumpPath  = "latency_histograms.txt";
+    cfg.traceDumpPath    = "trace.json";
+    cfg.barIntervals     = {1000, 60000, 300000};
+    cfg.orderBook        = true;
+    cfg.influxHttp       = false;
+    cfg.influxBatchBytes = 1 << 20;
+    cfg.influxFlushMs    = 1000;
+    cfg.dbWriterWait     = WaitMode::Park;
+    cfg.influxMaxPendingBytes = 64 << 20;
+    cfg.influxOverflow   = OverflowPolicy::Block;
+    cfg.metricsFile      = "hf_server.metrics";
+    cfg.metricsIntervalMs = 1000;
+    cfg.shutdownTimeoutMs = 5000;
+    cfg.metricsPort      = 0;
+    cfg.metricsBind      = "127.0.0.1";
+    cfg.replaySpeed      = 1.0;
+    cfg.replayStart      = 0;
+    cfg.ingestQueue       = 0;
+    cfg.ingestQueuePolicy = OverflowPolicy::Block;
+    cfg.ingestQueueWait   = WaitMode::Park;
 
     std::ifstream inFile(filename);
     if(!inFile.is_open()) {
@@ -37,6 +70,10 @@ Config loadConfig(const std::string &filename) {
             cfg.totalCores = std::stoi(val);
         } else if(key == "reserve_cores") {
             cfg.reserveCores = std::stoi(val);
+        } else if(key == "thread_pinning") {
+            cfg.threadPinning = (val == "1" || val == "true");
+        } else if(key == "pin_cpus") {
+            cfg.pinCpus = val;
         } else if(key == "symbols") {
             std::stringstream ss(val);
             std::string s;
@@ -45,12 +82,71 @@ Config loadConfig(const std::string &filename) {
                     cfg.symbols.push_back(s);
                 }
             }
+        } else if(key == "symbol_filter") {
+            cfg.symbolFilter = (val == "1" || val == "true");
         } else if(key == "data_mode") {
             if(val == "DEV") {
                 cfg.dataMode = DataMode::DEV;
+            } else if(val == "REPLAY") {
+                cfg.dataMode = DataMode::REPLAY;
             } else {
                 cfg.dataMode = DataMode::REAL;
             }
+        } else if(key == "latency_recording") {
+            cfg.latencyRecording = (val == "1" || val == "true");
+        } else if(key == "latency_dump") {
+            cfg.latencyDumpPath = val;
+        } else if(key == "trace_dump") {
+            cfg.traceDumpPath = val;
+        } else if(key == "bar_intervals") {
+            parseBarIntervals(val, cfg.barIntervals);
+        } else if(key == "order_book") {
+            cfg.orderBook = (val == "1" || val == "true");
+        } else if(key == "influx_http") {
+            cfg.influxHttp = (val == "1" || val == "true");
+        } else if(key == "influx_batch_bytes") {
+            cfg.influxBatchBytes = std::stoi(val);
+        } else if(key == "influx_flush_ms") {
+            cfg.influxFlushMs = std::stoi(val);
+        } else if(key == "influx_max_pending_bytes") {
+            cfg.influxMaxPendingBytes = std::stoi(val);
+        } else if(key == "influx_overflow") {
+            OverflowPolicy policy;
+            if(parseOverflowPolicy(val, policy) && policy == OverflowPolicy::Conflate) {
+                // Line-protocol rows carry no key to conflate on
+                std::cerr << "influx_overflow=conflate is not supported; keeping "
+                          << overflowPolicyName(cfg.influxOverflow) << std::endl;
+            } else {
+                parseOverflowPolicy(val, cfg.influxOverflow);
+            }
+        } else if(key == "db_writer_wait") {
+            parseWaitMode(val, cfg.dbWriterWait);
+        } else if(key == "metrics_file") {
+            cfg.metricsFile = val;
+        } else if(key == "metrics_interval_ms") {
+            cfg.metricsIntervalMs = std::stoi(val);
+        } else if(key == "shutdown_timeout_ms") {
+            cfg.shutdownTimeoutMs = std::stoi(val);
+        } else if(key == "metrics_port") {
+            cfg.metricsPort = std::stoi(val);
+        } else if(key == "metrics_bind") {
+            cfg.metricsBind = val;
+        } else if(key == "ingest_queue") {
+            cfg.ingestQueue = std::stoi(val);
+        } else if(key == "ingest_queue_policy") {
+            parseOverflowPolicy(val, cfg.ingestQueuePolicy);
+        } else if(key == "ingest_queue_wait") {
+            parseWaitMode(val, cfg.ingestQueueWait);
+        } else if(key == "input_file") {
+            cfg.inputFile = val;
+        } else if(key == "capture_file") {
+            cfg.captureFile = val;
+        } else if(key == "replay_file") {
+            cfg.replayFile = val;
+        } else if(key == "replay_speed") {
+            cfg.replaySpeed = std::stod(val);
+        } else if(key == "replay_start") {
+            cfg.replayStart = std::stoll(val);
         }
     }
     return cfg;
@@ -1,23 +1,26 @@
 // data_processor.cpp
 #include "../include/data_processor.hpp"
 #include "../include/influx_db_client.hpp"
-#include <json/json.h>
+#include "../include/mbo_message.hpp"
+#include "../include/mbo_pipeline.hpp"
+#include "../include/order_book.hpp"
 #include <iostream>
 #include <cstdlib>
-#include "../include/app_data.hpp"
+#include "../include/core_data.hpp"
 #include <sstream>
 #include <mutex>
 #include <string>
-#include <gtk/gtk.h>
+#include "../include/trace.hpp"
+#include "../include/metrics.hpp"
 
-#include <nlohmann/json.hpp>
-// For convenience
+// Debug log entries kept; older ones are dropped
+static const size_t DEBUG_LOG_LIMIT = 1000;
 
-// For convenience
-using json = nlohmann::json;
+// Distinct unknown type tags given their own counter; later ones share "other"
+static const size_t UNKNOWN_TYPE_LIMIT = 32;
 
-DataProcessor::DataProcessor(std::shared_ptr<InfluxDBClient> dbClient, AppData* app)
-    : db(dbClient), appData(app), errorCount(0)
+DataProcessor::DataProcessor(std::shared_ptr<InfluxDBClient> dbClient, CoreData* core)
+    : db(dbClient), coreData(core)
 {
 }
 
@@ -26,121 +29,231 @@ DataProcessor::~DataProcessor()
 }
 
 void DataProcessor::processResponse(const std::string &response, const std::string &streamID) {
+    HF_TRACE_SCOPE("processResponse");
+    StageClock clock(latency);
     try {
         logDebug("Received response: " + response);
 
-        // Attempt to parse the response
-        json root;
-        try {
-            root = json::parse(response);
-        } catch (const json::parse_error &e) {
+        // Parse and validate the response
+        MboMessage msg;
+        std::string parseError;
+        if (!parseMboMessage(response, msg, parseError)) {
             errorCount++;
-            logDebug("JSON parse error: " + std::string(e.what()) + " | Raw response: " + response);
+            logDebug(parseError + " | Raw response: " + response);
             incrementStreamError(streamID);
             return;
         }
+        clock.lap(LatencyStage::Parse);
 
-        // Validate JSON structure
-        if (!root.is_object()) {
-            errorCount++;
-            logDebug("Invalid JSON structure. Not an object. | Raw response: " + response);
-            incrementStreamError(streamID);
+        processMessage(msg, response, streamID, clock);
+    } catch (const std::exception &e) {
+        errorCount++;
+        logDebug("Exception caught: " + std::string(e.what()) + " | Raw response: " + response);
+        incrementStreamError(streamID);
+    }
+}
+
+void DataProcessor::processDecoded(const MboMessage &msg, const std::string &raw, const std::string &streamID) {
+    HF_TRACE_SCOPE("processDecoded");
+    StageClock clock(latency); // Parsing was paid for per block, so there is no Parse lap
+    try {
+        logDebug("Received response: " + raw);
+        processMessage(msg, raw, streamID, clock);
+    } catch (const std::exception &e) {
+        errorCount++;
+        logDebug("Exception caught: " + std::string(e.what()) + " | Raw response: " + raw);
+        incrementStreamError(streamID);
+    }
+}
+
+void DataProcessor::processMessage(const MboMessage &msg, const std::string &response,
+                                   const std::string &streamID, StageClock &clock) {
+    (this->*pipelines[static_cast<size_t>(msg.kind)])(msg, response, streamID, clock);
+}
+
+// The book change a message of type T makes
+template <MboType T>
+static void applyToBook(OrderBook &book, const MboMessage &msg) {
+    bool buy = msg.side == "buy";
+    if constexpr (T == MboType::Oba) {
+        book.add(msg.symbol, msg.orderID, buy, msg.priceTicks, msg.quantity);
+    } else if constexpr (T == MboType::Obr) {
+        book.replace(msg.symbol, msg.orderID, msg.newID, buy, msg.priceTicks, msg.quantity);
+    } else if constexpr (T == MboType::Obf) {
+        book.fill(msg.symbol, msg.orderID, msg.quantity);
+    } else {
+        book.remove(msg.symbol, msg.orderID);
+    }
+}
+
+template <MboType T>
+void DataProcessor::runPipeline(const MboMessage &msg, const std::string &response,
+                                const std::string &streamID, StageClock &clock) {
+    using Traits = MboTypeTraits<T>;
+
+    // Increment stream stats
+    if constexpr ((Traits::sinks & MBO_SINK_STATS) != 0) {
+        if (!recordStreamMessage(streamID)) {
+            logDebug("Failed to emplace DataStreamStats for stream: " + streamID + " | Raw response: " + response);
             return;
         }
+        clock.lap(LatencyStage::Stats);
+    }
+    typeCounts[static_cast<size_t>(T)].fetch_add(1, std::memory_order_relaxed);
 
-        // Required fields
-        std::vector<std::string> requiredFields = {
-            "type", "s", "tm", "q", "p", "x", "id", "a", "mid"
-        };
-
-        for (const auto &field : requiredFields) {
-            if (!root.contains(field)) {
-                errorCount++;
-                logDebug("Missing required field: " + field + " | Raw response: " + response);
-                incrementStreamError(streamID);
-                return;
-            }
-        }
+    // Fold the price into this frame's interval for graphing, and trades into the bars
+    if constexpr ((Traits::sinks & MBO_SINK_BARS) != 0) {
+        coreData->bars.add(msg.symbol, msg.timestamp, msg.price, msg.quantity);
+    }
+    if constexpr ((Traits::sinks & MBO_SINK_TICKER) != 0) {
+        coreData->tickerConflator.record(msg.symbol, msg.price);
+        clock.lap(LatencyStage::Ticker);
+    }
 
-        // Extract fields
-        std::string msgType = root["type"].get<std::string>();
-        std::string symbol = root["s"].get<std::string>();
-        long long timestamp = root["tm"].get<long long>();
-        int quantity = root["q"].get<int>();
-        double price = root["p"].get<double>();
-        std::string side = root["x"].get<std::string>();
-        std::string orderID = root["id"].get<std::string>();
-        std::string attr = root["a"].get<std::string>();
-        std::string matchID = root["mid"].get<std::string>();
-
-        // Increment stream stats
-        {
-            std::lock_guard<std::mutex> lock(appData->statsMutex);
-            auto it = appData->dataStreamStats.find(streamID);
-            if (it == appData->dataStreamStats.end()) {
-                // Insert a new DataStreamStats object if not present
-                auto emplaceResult = appData->dataStreamStats.emplace(
-                    streamID, std::make_shared<DataStreamStats>());
-                if (!emplaceResult.second) {
-                    logDebug("Failed to emplace DataStreamStats for stream: " + streamID + " | Raw response: " + response);
-                    return;
-                }
-                it = emplaceResult.first;
-            }
-            // Increment messagesReceived
-            it->second->messagesReceived++;
+    // Keep the order book current
+    if constexpr ((Traits::sinks & MBO_SINK_BOOK) != 0) {
+        if(coreData->book.enabled()) {
+            applyToBook<T>(coreData->book, msg);
+            clock.lap(LatencyStage::Book);
         }
-         // Add ticker data for graphing
-        {
-            std::lock_guard<std::mutex> lock(appData->dataMutex);
-            if(appData->tickerMap.find(symbol) == appData->tickerMap.end()) {
-                appData->tickerMap[symbol] = TickerData();
-            }
-            appData->tickerMap[symbol].values.push_back(price);
+    }
+
+    // Store the event
+    if constexpr ((Traits::sinks & MBO_SINK_STORAGE) != 0) {
+        const std::string &orderID = Traits::orderIdField == MBO_FIELD_NEW_ID ? msg.newID : msg.orderID;
+        db->write("order_book", msg.symbol, msg.price, msg.timestamp, msg.quantity,
+                  msg.side, orderID, msg.attribution, msg.matchID);
+    }
+    if constexpr ((Traits::sinks & MBO_SINK_UNKNOWN) != 0) {
+        countUnknownType(msg.type, response);
+    }
+    clock.lap(LatencyStage::DbWrite);
+    clock.finish();
+}
+
+// One pipeline instantiation per MboType; a type without MboTypeTraits fails to compile
+const std::array<DataProcessor::Pipeline, MBO_TYPE_COUNT> DataProcessor::pipelines =
+    DataProcessor::makePipelines(std::make_index_sequence<MBO_TYPE_COUNT>());
 
-            // Optional: Limit the size of the values vector to prevent unbounded growth
-            if(appData->tickerMap[symbol].values.size() > 1000) { // Adjust the limit as needed
-                appData->tickerMap[symbol].values.erase(appData->tickerMap[symbol].values.begin(),
-                                                       appData->tickerMap[symbol].values.end() - 1000);
+void DataProcessor::countUnknownType(const std::string &tag, const std::string &response)
+{
+    std::shared_ptr<std::atomic<uint64_t>> counter;
+    {
+        std::lock_guard<std::mutex> lock(unknownTypesMutex);
+        auto it = unknownTypes.find(tag);
+        if (it == unknownTypes.end()) {
+            const std::string key = unknownTypes.size() < UNKNOWN_TYPE_LIMIT ? tag : "other";
+            it = unknownTypes.find(key);
+            if (it == unknownTypes.end()) {
+                // Logged once per type; later messages of the type are only counted
+                logDebug("Unhandled message type: " + tag + " | Raw response: " + response);
+                it = unknownTypes.emplace(key, std::make_shared<std::atomic<uint64_t>>(0)).first;
+                std::shared_ptr<std::atomic<uint64_t>> created = it->second;
+                MetricsRegistry::instance().counterCallback(
+                    "hf_unknown_type_messages_total", "Messages with an unhandled type tag",
+                    metricLabel("type", key), [created] { return static_cast<double>(created->load()); });
             }
         }
+        counter = it->second;
+    }
+    counter->fetch_add(1, std::memory_order_relaxed);
+}
 
-        // Route events
-        if (msgType == "oba" || msgType == "obf" || msgType == "obc" || msgType == "obd" || msgType == "obb") {
-            db->write("order_book", symbol, price, timestamp, quantity, side, orderID, attr, matchID);
-        } else if (msgType == "obr") {
-            std::string newID = root.value("nid", "");
-            db->write("order_book", symbol, price, timestamp, quantity, side, newID, attr, matchID);
-        } else {
-            logDebug("Unhandled message type: " + msgType + " | Raw response: " + response);
-        }
-    } catch (const std::exception &e) {
-        errorCount++;
-        logDebug("Exception caught: " + std::string(e.what()) + " | Raw response: " + response);
-        incrementStreamError(streamID);
+std::map<std::string, uint64_t> DataProcessor::unknownTypeCounts()
+{
+    std::lock_guard<std::mutex> lock(unknownTypesMutex);
+    std::map<std::string, uint64_t> counts;
+    for (const auto &entry : unknownTypes) {
+        counts[entry.first] = entry.second->load();
     }
+    return counts;
 }
 
+bool DataProcessor::admitSymbol(const char* data, size_t size)
+{
+    if(!coreData || !coreData->symbolFilter.enabled()) {
+        return true;
+    }
+    const char* symbol;
+    size_t length;
+    return !scanSymbolField(data, size, symbol, length) || admitSymbolName(symbol, length);
+}
+
+bool DataProcessor::admitSymbolName(const char* symbol, size_t length)
+{
+    if(!coreData || !coreData->symbolFilter.enabled() || coreData->symbolFilter.contains(symbol, length)) {
+        return true;
+    }
+    filteredCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void DataProcessor::captureInbound(const std::string &raw)
+{
+    if(coreData && coreData->capture.active()) {
+        coreData->capture.record(raw);
+    }
+}
+
+bool DataProcessor::recordStreamMessage(const std::string &streamID)
+{
+    std::shared_ptr<DataStreamStats> stats = streamStats(streamID);
+    if (!stats) {
+        return false;
+    }
+    // Increment messagesReceived
+    stats->messagesReceived++;
+    return true;
+}
+
+std::shared_ptr<DataStreamStats> DataProcessor::streamStats(const std::string &streamID)
+{
+    std::lock_guard<std::mutex> lock(coreData->statsMutex);
+    auto it = coreData->dataStreamStats.find(streamID);
+    if (it == coreData->dataStreamStats.end()) {
+        // Insert a new DataStreamStats object if not present
+        auto emplaceResult = coreData->dataStreamStats.emplace(
+            streamID, std::make_shared<DataStreamStats>());
+        if (!emplaceResult.second) {
+            return nullptr;
+        }
+        it = emplaceResult.first;
+
+        // Expose the new stream's counters; the callbacks keep the stats alive
+        std::shared_ptr<DataStreamStats> stats = it->second;
+        std::string label = metricLabel("stream", streamID);
+        MetricsRegistry &reg = MetricsRegistry::instance();
+        reg.counterCallback("hf_stream_messages_total", "Messages processed per data stream", label,
+                            [stats] { return static_cast<double>(stats->messagesReceived.load()); });
+        reg.counterCallback("hf_stream_errors_total", "Rejected messages per data stream", label,
+                            [stats] { return static_cast<double>(stats->errors.load()); });
+    }
+    return it->second;
+}
 
 void DataProcessor::logDebug(const std::string &reason)
 {
     std::lock_guard<std::mutex> lock(debugMutex);
+    if(debugLogs.size() >= DEBUG_LOG_LIMIT) {
+        debugLogs.pop_front();
+        debugLogsDropped.fetch_add(1, std::memory_order_relaxed);
+    }
     debugLogs.push_back(reason);
 }
 
 std::vector<std::string> DataProcessor::getDebugLogs()
 {
     std::lock_guard<std::mutex> lock(debugMutex);
-    return debugLogs;
+    return std::vector<std::string>(debugLogs.begin(), debugLogs.end());
 }
 
 void DataProcessor::incrementStreamError(const std::string &streamID)
 {
     if (streamID.empty()) return;
 
-    std::lock_guard<std::mutex> lock(appData->statsMutex);
-    auto it = appData->dataStreamStats.find(streamID);
-    if (it != appData->dataStreamStats.end()) {
+    std::lock_guard<std::mutex> lock(coreData->statsMutex);
+    auto it = coreData->dataStreamStats.find(streamID);
+    if (it != coreData->dataStreamStats.end()) {
         it->second->errors++;
     }
 }
\ No newline at end of file
@@ -1,11 +1,28 @@
 #include "../include/dev_monitor.hpp"
+#include "../include/message_framer.hpp"
+#include "../include/capture_file.hpp"
+#include "../include/mbo_block_decoder.hpp"
+#include "../include/trace.hpp"
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <thread>
 #include <nlohmann/json.hpp>
 
-DevMonitor::DevMonitor(std::shared_ptr<DataProcessor> processor)
-    : dataProcessor(processor)
+// Bytes of a mapped range decoded per block by runRange
+static const size_t RANGE_BLOCK_BYTES = 1 << 20;
+
+static bool isBlank(const char* begin, const char* end) {
+    for (const char* p = begin; p < end; ++p) {
+        if (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') return false;
+    }
+    return true;
+}
+
+DevMonitor::DevMonitor(std::shared_ptr<DataProcessor> processor, std::istream &input)
+    : dataProcessor(processor), input(&input)
 {
 }
 
@@ -13,54 +30,179 @@ DevMonitor::~DevMonitor()
 {
 }
 
+void DevMonitor::handleMessage(const std::string &message, const std::string &streamID,
+                               StageClock &clock, std::atomic<int> &requestCount)
+{
+    if (!dataProcessor->admitSymbol(message.data(), message.size())) {
+        return; // Unsubscribed symbol; skip validation and parsing
+    }
+
+    // Validate the extracted JSON without building it; processResponse parses it
+    if (!nlohmann::json::accept(message)) {
+        // The invalid object has already been consumed; resume at the next '{'
+        std::cerr << "JSON parse error: invalid object | Buffer content: " << message << std::endl;
+        return;
+    }
+
+    // Process the JSON line
+    clock.lap(LatencyStage::Frame);
+    requestCount++;
+    dataProcessor->processResponse(message, streamID);
+}
+
 void DevMonitor::run(std::atomic<bool> &stopFlag, std::atomic<int> &requestCount)
 {
-    std::string buffer; // Buffer to accumulate input
+    MessageFramer framer; // Accumulates input and splits it into JSON objects
+    std::string jsonLine;
+    const std::string streamID = "DEV";
 
     while (!stopFlag) {
-        std::string input;
-        if (!std::getline(std::cin, input)) {
+        std::string line;
+        if (!std::getline(*input, line)) {
             break; // End of input
         }
 
         // Add new input to the buffer
-        buffer += input;
+        framer.append(line);
 
         while (true) {
-            try {
-                // Look for the start and end of a JSON object
-                auto jsonStart = buffer.find('{');
-                auto jsonEnd = buffer.find('}', jsonStart);
+            StageClock clock(dataProcessor->latency);
+            if (!framer.next(jsonLine)) {
+                break; // No complete JSON object found yet
+            }
+            dataProcessor->captureInbound(jsonLine);
+            handleMessage(jsonLine, streamID, clock, requestCount);
+        }
+    }
+}
 
-                if (jsonStart == std::string::npos || jsonEnd == std::string::npos) {
-                    break; // No complete JSON object found yet
-                }
+void DevMonitor::runReader(BoundedQueue<std::string> &queue, std::atomic<bool> &stopFlag)
+{
+    MessageFramer framer;
+    std::string jsonLine;
+
+    while (!stopFlag) {
+        std::string line;
+        if (!std::getline(*input, line)) {
+            break; // End of input
+        }
+        framer.append(line);
+        while (framer.next(jsonLine)) {
+            dataProcessor->captureInbound(jsonLine);
+            if (dataProcessor->admitSymbol(jsonLine.data(), jsonLine.size())) {
+                queue.push(std::move(jsonLine));
+            }
+        }
+    }
+    queue.close();
+}
 
-                // Extract the JSON line
-                std::string jsonLine = buffer.substr(jsonStart, jsonEnd - jsonStart + 1);
+void DevMonitor::runWorker(BoundedQueue<std::string> &queue, std::atomic<bool> &stopFlag,
+                           std::atomic<int> &requestCount)
+{
+    const std::string streamID = "DEV";
+    std::string message;
+    while (!stopFlag && !queue.drained()) {
+        if (!queue.pop(message, std::chrono::milliseconds(100))) {
+            continue;
+        }
+        StageClock clock(dataProcessor->latency);
+        handleMessage(message, streamID, clock, requestCount);
+    }
+}
 
-                // Validate the extracted JSON
-                nlohmann::json::parse(jsonLine); // Throws if invalid
+void DevMonitor::runRange(const char* begin, const char* end,
+                          std::atomic<bool> &stopFlag, std::atomic<int> &requestCount)
+{
+    const std::string streamID = "DEV";
+    std::string message; // Reused; processResponse needs a std::string
+    MboBlockDecoder decoder;
+    decoder.setSymbolPredicate([this](const char* symbol, size_t length) {
+        return dataProcessor->admitSymbolName(symbol, length);
+    });
 
-                // Process the JSON line
-                requestCount++;
-                dataProcessor->processResponse(jsonLine, "DEV");
+    const char* block = begin;
+    while (block < end && !stopFlag) {
+        // Decode a line-aligned block up front, then walk its lines
+        const char* blockEnd = end;
+        if (static_cast<size_t>(end - block) > RANGE_BLOCK_BYTES) {
+            const char* newline = static_cast<const char*>(
+                std::memchr(block + RANGE_BLOCK_BYTES, '\n', end - block - RANGE_BLOCK_BYTES));
+            blockEnd = newline ? newline + 1 : end;
+        }
+        {
+            HF_TRACE_SCOPE("decodeBlock");
+            decoder.decode(block, static_cast<size_t>(blockEnd - block));
+        }
+        const char* decodedEnd = block + decoder.consumed();
 
-                // Remove processed data from the buffer
-                buffer.erase(0, jsonEnd + 1);
-            } catch (const nlohmann::json::parse_error &e) {
-                // Log and attempt recovery
-                std::cerr << "JSON parse error: " << e.what() << " | Buffer content: " << buffer << std::endl;
+        size_t r = 0;
+        const char* p = block;
+        while (p < decodedEnd && !stopFlag) {
+            StageClock clock(dataProcessor->latency);
+            const char* newline = static_cast<const char*>(std::memchr(p, '\n', decodedEnd - p));
+            const char* lineEnd = newline ? newline : decodedEnd;
+            const char* next = newline ? newline + 1 : decodedEnd;
+            if (lineEnd > p && lineEnd[-1] == '\r') {
+                lineEnd--;
+            }
+            if (lineEnd > p) {
+                // The line is taken as decoded only if it holds exactly one record
+                const MboBlockRecord* rec = nullptr;
+                uint32_t lineBegin = static_cast<uint32_t>(p - block);
+                uint32_t lineStop = static_cast<uint32_t>(lineEnd - block);
+                while (r < decoder.size() && decoder[r].begin < lineBegin) r++;
+                if (r < decoder.size() && decoder[r].end <= lineStop &&
+                    (r + 1 == decoder.size() || decoder[r + 1].begin >= lineStop) &&
+                    isBlank(p, block + decoder[r].begin) && isBlank(block + decoder[r].end, lineEnd)) {
+                    rec = &decoder[r];
+                }
 
-                // Find the next potential JSON start position
-                auto nextStart = buffer.find('{', buffer.find('}') + 1);
-                if (nextStart != std::string::npos) {
-                    buffer.erase(0, nextStart); // Discard invalid part of the buffer
+                message.assign(p, lineEnd);
+                dataProcessor->captureInbound(message);
+                if (rec && rec->filtered) {
+                    // Unsubscribed symbol, dropped undecoded; counted by the processor
+                } else if (rec) {
+                    clock.lap(LatencyStage::Frame);
+                    requestCount++;
+                    dataProcessor->processDecoded(rec->msg, message, streamID);
                 } else {
-                    buffer.clear(); // No valid JSON start, clear the buffer
+                    handleMessage(message, streamID, clock, requestCount);
                 }
-                break; // Exit the inner loop to process the next input
             }
+            p = next;
         }
+        block = decodedEnd;
+    }
+}
+
+void DevMonitor::replay(CaptureReader &capture, double speed, uint64_t recordLimit,
+                        const std::string &streamID, std::atomic<bool> &stopFlag, std::atomic<int> &requestCount)
+{
+    using Clock = std::chrono::steady_clock;
+    std::string message; // Reused; processResponse needs a std::string
+    CaptureRecord rec;
+    uint64_t firstNs = 0;
+    bool first = true;
+    auto start = Clock::now();
+
+    for (uint64_t n = 0; n < recordLimit && !stopFlag && capture.next(rec); ++n) {
+        if (first) {
+            firstNs = rec.receiveNs;
+            first = false;
+        }
+
+        if (speed > 0.0 && rec.receiveNs > firstNs) {
+            auto due = start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::nano>((rec.receiveNs - firstNs) / speed));
+            // Wait in slices so a stop request is not held up by a long gap
+            while (!stopFlag && Clock::now() < due) {
+                std::this_thread::sleep_for(std::min<Clock::duration>(due - Clock::now(), std::chrono::milliseconds(100)));
+            }
+        }
+
+        StageClock clock(dataProcessor->latency);
+        message.assign(rec.data, rec.size);
+        handleMessage(message, streamID, clock, requestCount);
     }
 }
@@ -0,0 +1,618 @@
+////////////////////////////////////////////////////////////////////////////////
+// graph_renderer.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/graph_renderer.hpp"
+#include "../include/latency_histogram.hpp"
+#include "../include/metrics.hpp"
+#include "../include/series_decimation.hpp"
+#include "../include/trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+// Margins around the stacked graphs
+static const double margin_left = 60.0;
+static const double margin_right = 20.0;
+static const double margin_top = 20.0;
+static const double margin_bottom = 60.0;
+static const double graph_spacing = 40.0; // Space between stacked graphs
+
+// Grid lines (and labels) per axis
+static const int numYLabels = 5;
+static const int numXLabels = 5;
+
+// Top and height of the plot area of sub-graph index (of count)
+static void graphGeometry(double height, size_t count, size_t index, double &graph_y, double &graphHeight) {
+    graphHeight = (height - margin_top - margin_bottom - (count - 1) * graph_spacing) / count;
+    graph_y = margin_top + (graphHeight + graph_spacing) * index;
+}
+
+GdkRectangle graphRegion(int width, int height, size_t count, size_t index) {
+    double graph_y, graphHeight;
+    graphGeometry(height, count, index, graph_y, graphHeight);
+
+    // Half the spacing above (title) and below (X labels)
+    double top = std::max(0.0, graph_y - graph_spacing / 2);
+    double bottom = std::min(static_cast<double>(height), graph_y + graphHeight + graph_spacing / 2);
+    GdkRectangle region;
+    region.x = 0;
+    region.y = static_cast<int>(std::lround(top));
+    region.width = width;
+    region.height = std::max(0, static_cast<int>(std::lround(bottom)) - region.y);
+    return region;
+}
+
+double graphPlotWidth(int width) {
+    return std::max(1.0, width - margin_left - margin_right);
+}
+
+double graphWindowSeconds(const GraphViewport &view) {
+    double full = view.candles ? GRAPH_CANDLES_VISIBLE * view.barIntervalMs / 1000.0 : GRAPH_HISTORY_SECONDS;
+    return full / std::max(view.xScale, 1.0);
+}
+
+double graphPlotHeight(int height, size_t count) {
+    double graph_y, graphHeight;
+    graphGeometry(height, std::max<size_t>(count, 1), 0, graph_y, graphHeight);
+    return std::max(1.0, graphHeight);
+}
+
+// Smallest 1, 2 or 5 x 10^k that is at least raw
+static double niceStep(double raw) {
+    double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+    for(double m : {1.0, 2.0, 5.0}) {
+        if(raw <= m * magnitude) return m * magnitude;
+    }
+    return 10.0 * magnitude;
+}
+
+// Widens [lo, hi] to numYLabels nice steps, so the axis (and its cached
+// layer) only changes once the series leaves it
+static void niceAxisRange(double &lo, double &hi) {
+    if(!(hi > lo) || !std::isfinite(hi - lo)) return;
+    double step = niceStep((hi - lo) / numYLabels);
+    while(true) {
+        double first = std::floor(lo / step) * step;
+        if(first + step * numYLabels >= hi) {
+            lo = first;
+            hi = first + step * numYLabels;
+            return;
+        }
+        step = niceStep(step * 1.5); // Next nice step: 1 -> 2 -> 5 -> 10
+    }
+}
+
+// Colour of the index-th sub-graph
+static void tickerColor(size_t index, double &r, double &g, double &b) {
+    r = std::min(index * 0.2, 1.0);
+    g = std::min(index * 0.3, 1.0);
+    b = std::min(index * 0.5, 1.0);
+}
+
+// Widget coordinates of a (time, value) point in one sub-graph's plot area
+struct PlotMapping {
+    double left = 0.0;        // Plot area left edge
+    double bottom = 0.0;      // Plot area bottom edge
+    double windowStart = 0.0; // Time at the left edge
+    double xScale = 1.0;      // Pixels per second
+    double axisMin = 0.0;     // Value (log10 value on a log scale) at the bottom edge
+    double yScale = 1.0;      // Pixels per value unit
+    bool logScale = false;
+
+    double x(double time) const { return left + (time - windowStart) * xScale; }
+    double y(double value) const {
+        if(logScale && value > 0.0) value = std::log10(value);
+        return bottom - (value - axisMin) * yScale;
+    }
+};
+
+// Bars [first, last) that overlap [windowStart, windowEnd] (seconds)
+static void visibleBars(const BarSeries &series, double windowStart, double windowEnd, size_t &first, size_t &last) {
+    const std::vector<Bar> &bars = series.bars;
+    double interval = series.intervalMs / 1000.0;
+    first = std::lower_bound(bars.begin(), bars.end(), windowStart, [interval](const Bar &bar, double t) {
+        return bar.start / 1000.0 + interval <= t;
+    }) - bars.begin();
+    last = std::upper_bound(bars.begin() + first, bars.end(), windowEnd, [](double t, const Bar &bar) {
+        return t < bar.start / 1000.0;
+    }) - bars.begin();
+}
+
+// Candlesticks of bars [first, last), with their volume along the bottom fifth of the plot
+static void drawCandles(cairo_t* cr, const BarSeries &series, size_t first, size_t last, const PlotMapping &map,
+                        double graphHeight) {
+    const std::vector<Bar> &bars = series.bars;
+    double interval = series.intervalMs / 1000.0;
+    double bodyWidth = std::max(1.0, interval * map.xScale * 0.7);
+
+    long long maxVolume = 0;
+    for(size_t i = first; i < last; ++i) maxVolume = std::max(maxVolume, bars[i].volume);
+    if(maxVolume > 0) {
+        cairo_set_source_rgb(cr, 0.82, 0.82, 0.88);
+        for(size_t i = first; i < last; ++i) {
+            double height = graphHeight * 0.2 * bars[i].volume / static_cast<double>(maxVolume);
+            double x = map.x(bars[i].start / 1000.0 + interval / 2);
+            cairo_rectangle(cr, x - bodyWidth / 2, map.bottom - height, bodyWidth, height);
+        }
+        cairo_fill(cr);
+    }
+
+    cairo_set_line_width(cr, 1.0);
+    for(size_t i = first; i < last; ++i) {
+        const Bar &bar = bars[i];
+        if(bar.close >= bar.open) {
+            cairo_set_source_rgb(cr, 0.1, 0.6, 0.2); // Up
+        } else {
+            cairo_set_source_rgb(cr, 0.8, 0.15, 0.15); // Down
+        }
+        double x = map.x(bar.start / 1000.0 + interval / 2);
+        cairo_move_to(cr, x, map.y(bar.high));
+        cairo_line_to(cr, x, map.y(bar.low));
+        cairo_stroke(cr);
+
+        double top = std::min(map.y(bar.open), map.y(bar.close));
+        double bodyHeight = std::max(1.0, std::fabs(map.y(bar.open) - map.y(bar.close)));
+        cairo_rectangle(cr, x - bodyWidth / 2, top, bodyWidth, bodyHeight);
+        cairo_fill(cr);
+    }
+}
+
+// Image surface of width x height widget pixels at the given device scale
+static cairo_surface_t* createSurface(int width, int height, int scale) {
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, std::max(width, 1) * scale,
+                                                          std::max(height, 1) * scale);
+    cairo_surface_set_device_scale(surface, scale, scale);
+    return surface;
+}
+
+// Grid, axis labels and title of one sub-graph, rendered once and reused
+// until the region, Y axis, scale or X extent changes
+struct GraphRenderer::Layer {
+    cairo_surface_t* surface = nullptr;
+    GdkRectangle region = {0, 0, 0, 0};
+    int scale = 1;
+    size_t index = 0;
+    double axisMin = 0.0;
+    double axisMax = 0.0;
+    bool logScale = false;
+    double span = 0.0;   // Visible seconds
+    double offset = 0.0; // Seconds between the right edge and the newest sample
+
+    ~Layer() {
+        if(surface) cairo_surface_destroy(surface);
+    }
+
+    void render(const std::string &ticker, double graph_y, double graphHeight);
+};
+
+void GraphRenderer::Layer::render(const std::string &ticker, double graph_y, double graphHeight) {
+    static MetricCounter &rebuilds = MetricsRegistry::instance().counter(
+        "hf_render_layer_rebuilds_total", "Graph grid/label layers rendered again");
+    rebuilds.inc();
+
+    if(surface) cairo_surface_destroy(surface);
+    surface = createSurface(region.width, region.height, scale);
+    cairo_t* cr = cairo_create(surface);
+    cairo_translate(cr, -region.x, -region.y); // Draw in widget coordinates
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_paint(cr);
+
+    double width = region.x + region.width;
+    double axisRange = axisMax - axisMin;
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 10.0);
+
+    // Y grid lines and labels
+    char label[64];
+    for(int i = 0; i <= numYLabels; ++i) {
+        double yValue = axisMin + i * axisRange / numYLabels;
+        double yPos = graph_y + graphHeight - i * graphHeight / numYLabels;
+
+        cairo_set_source_rgb(cr, 0.9, 0.9, 0.9); // Light gray grid
+        cairo_set_line_width(cr, 0.5);
+        cairo_move_to(cr, margin_left, yPos);
+        cairo_line_to(cr, width - margin_right, yPos);
+        cairo_stroke(cr);
+
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        std::snprintf(label, sizeof(label), "%.2f", logScale ? std::pow(10, yValue) : yValue);
+        cairo_move_to(cr, 5, yPos + 5); // Left of the Y axis
+        cairo_show_text(cr, label);
+    }
+
+    // X grid lines and labels in seconds before the newest sample
+    double xStep = (width - margin_left - margin_right) / static_cast<double>(numXLabels);
+    for(int i = 0; i <= numXLabels; ++i) {
+        double xPos = margin_left + i * xStep;
+
+        cairo_set_source_rgb(cr, 0.9, 0.9, 0.9);
+        cairo_set_line_width(cr, 0.5);
+        cairo_move_to(cr, xPos, graph_y);
+        cairo_line_to(cr, xPos, graph_y + graphHeight);
+        cairo_stroke(cr);
+
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        double secondsAgo = offset + span * (numXLabels - i) / numXLabels;
+        if(span >= 600.0) {
+            std::snprintf(label, sizeof(label), "%.0fm", secondsAgo > 0.0 ? -secondsAgo / 60.0 : 0.0);
+        } else {
+            std::snprintf(label, sizeof(label), "%.*fs", span < 10.0 ? 1 : 0, secondsAgo > 0.0 ? -secondsAgo : 0.0);
+        }
+        cairo_move_to(cr, xPos - 10, graph_y + graphHeight + 15); // Below the X axis
+        cairo_show_text(cr, label);
+    }
+
+    // Ticker name at the top-left, in the line colour
+    double r, g, b;
+    tickerColor(index, r, g, b);
+    cairo_set_source_rgb(cr, r, g, b);
+    cairo_move_to(cr, margin_left, graph_y - 5);
+    cairo_show_text(cr, ticker.c_str());
+
+    cairo_destroy(cr);
+}
+
+GraphRenderer::GraphRenderer(GtkWidget* drawingArea)
+    : widget(drawingArea), requestWait(WaitMode::Park)
+{
+}
+
+GraphRenderer::~GraphRenderer()
+{
+    stop();
+    for(Frame &frame : frames) {
+        if(frame.surface) cairo_surface_destroy(frame.surface);
+    }
+}
+
+void GraphRenderer::start() {
+    if(worker.joinable()) return;
+    MetricsRegistry &metrics = MetricsRegistry::instance();
+    metrics.counterCallback("hf_render_frames_total", "Graph frames rasterized by the render worker", "",
+                            [this] { return static_cast<double>(framesRendered()); });
+    metrics.counterCallback("hf_render_frames_dropped_total", "Graph frames superseded before rendering", "",
+                            [this] { return static_cast<double>(framesDropped()); });
+
+    stopRequested.store(false);
+    worker = std::thread([this] {
+        HF_TRACE_THREAD_NAME("graph-render");
+        run();
+    });
+}
+
+void GraphRenderer::stop() {
+    stopRequested.store(true, std::memory_order_release);
+    requestWait.notify();
+    if(worker.joinable()) worker.join();
+}
+
+void GraphRenderer::submit(GraphFrameRequest request) {
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        if(hasPending) {
+            // The waiting frame is never drawn; keep the series it carried that this one does not
+            for(auto &kv : pending.changed) {
+                request.changed.emplace(kv.first, std::move(kv.second));
+            }
+            for(auto &kv : pending.changedBars) {
+                request.changedBars.emplace(kv.first, std::move(kv.second));
+            }
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        pending = std::move(request);
+        hasPending = true;
+        requestReady.store(true, std::memory_order_release);
+    }
+    requestWait.notify();
+}
+
+void GraphRenderer::blit(cairo_t* cr) {
+    std::lock_guard<std::mutex> lock(frameMutex);
+    const Frame &frame = frames[front];
+    if(!frame.surface) {
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+        return;
+    }
+    // Until the frame for a new size arrives, pad the old one with white
+    int width = gtk_widget_get_allocated_width(widget);
+    int height = gtk_widget_get_allocated_height(widget);
+    if(width > frame.width || height > frame.height) {
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+    }
+    cairo_set_source_surface(cr, frame.surface, 0, 0);
+    cairo_rectangle(cr, 0, 0, frame.width, frame.height);
+    cairo_fill(cr);
+}
+
+void GraphRenderer::run() {
+    while(!stopRequested.load(std::memory_order_acquire)) {
+        requestWait.waitUntil([this] {
+            return requestReady.load(std::memory_order_acquire) || stopRequested.load(std::memory_order_acquire);
+        }, std::chrono::milliseconds(100));
+
+        GraphFrameRequest request;
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            if(!hasPending) continue;
+            request = std::move(pending);
+            pending = GraphFrameRequest();
+            hasPending = false;
+            requestReady.store(false, std::memory_order_relaxed);
+        }
+        render(request);
+    }
+}
+
+void GraphRenderer::render(GraphFrameRequest &request) {
+    HF_TRACE_SCOPE("graph render");
+    static MetricHistogram &frameTime = MetricsRegistry::instance().histogram(
+        "hf_render_frame_seconds", "Time to rasterize one graph frame", "", secondsPerTick());
+    uint64_t begin = readTicks();
+
+    // Latest data of every plotted ticker
+    for(auto &kv : request.changed) {
+        series[kv.first] = std::move(kv.second);
+    }
+    for(auto &kv : request.changedBars) {
+        bars[kv.first] = std::move(kv.second);
+    }
+    auto plotted = [&request](const std::string &symbol) {
+        return std::any_of(request.layout.begin(), request.layout.end(),
+                           [&](const GraphSeriesState &s) { return s.symbol == symbol; });
+    };
+    auto prune = [&plotted](auto &map) {
+        for(auto it = map.begin(); it != map.end();) {
+            it = plotted(it->first) ? std::next(it) : map.erase(it);
+        }
+    };
+    prune(series);
+    prune(bars);
+    prune(layers);
+
+    // Every sub-graph shares the time axis, which ends at the newest sample (or bar end)
+    double newest = 0.0;
+    if(request.view.candles) {
+        for(const auto &kv : bars) {
+            const BarSeries &bs = kv.second;
+            if(!bs.bars.empty()) newest = std::max(newest, (bs.bars.back().start + bs.intervalMs) / 1000.0);
+        }
+    } else {
+        for(const auto &kv : series) {
+            if(!kv.second.times.empty()) newest = std::max(newest, kv.second.times.back());
+        }
+    }
+    // Snapped so a new sample only redraws its own sub-graph until the axis crosses a step
+    double axisStep = graphWindowSeconds(request.view) / GRAPH_AXIS_STEPS;
+    if(newest > 0.0 && axisStep > 0.0) {
+        newest = std::ceil(newest / axisStep) * axisStep;
+    }
+
+    // The back surface only needs the sub-graphs that changed since it was last drawn
+    Frame &frame = frames[1 - front];
+    bool full = !frame.surface || frame.width != request.width || frame.height != request.height ||
+                frame.scale != request.scale || !(frame.view == request.view) || frame.newest != newest ||
+                frame.layout.size() != request.layout.size();
+    for(size_t i = 0; !full && i < request.layout.size(); ++i) {
+        full = frame.layout[i].symbol != request.layout[i].symbol;
+    }
+    if(!frame.surface || frame.width != request.width || frame.height != request.height ||
+       frame.scale != request.scale) {
+        if(frame.surface) cairo_surface_destroy(frame.surface);
+        frame.surface = createSurface(request.width, request.height, request.scale);
+        frame.width = request.width;
+        frame.height = request.height;
+        frame.scale = request.scale;
+    }
+
+    std::vector<GdkRectangle> changed;
+    cairo_t* cr = cairo_create(frame.surface);
+    if(full) {
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+        changed.push_back({0, 0, request.width, request.height});
+        if(request.layout.empty()) {
+            cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+            cairo_set_source_rgb(cr, 0, 0, 0);
+            cairo_move_to(cr, margin_left, request.height / 2);
+            cairo_show_text(cr, "No data to display. Please select tickers.");
+        }
+    }
+    for(size_t i = 0; i < request.layout.size(); ++i) {
+        if(!full && frame.layout[i] == request.layout[i]) continue;
+        GdkRectangle region = graphRegion(request.width, request.height, request.layout.size(), i);
+        cairo_save(cr);
+        cairo_rectangle(cr, region.x, region.y, region.width, region.height);
+        cairo_clip(cr);
+        drawGraph(cr, request, i, newest);
+        cairo_restore(cr);
+        if(!full) changed.push_back(region);
+    }
+    cairo_destroy(cr);
+    cairo_surface_flush(frame.surface);
+    frame.layout = std::move(request.layout);
+    frame.view = request.view;
+    frame.newest = newest;
+
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        front = 1 - front;
+        damage.insert(damage.end(), changed.begin(), changed.end());
+    }
+    uint64_t elapsed = readTicks() - begin;
+    frameTime.record(elapsed);
+    lastFrame.store(static_cast<double>(elapsed) * secondsPerTick(), std::memory_order_relaxed);
+    rendered.fetch_add(1, std::memory_order_relaxed);
+
+    // One repaint request in flight at a time; it picks up all damage so far
+    if(!repaintQueued.exchange(true)) {
+        g_idle_add(on_frame_ready, this);
+    }
+}
+
+gboolean GraphRenderer::on_frame_ready(gpointer user_data) {
+    GraphRenderer* renderer = static_cast<GraphRenderer*>(user_data);
+    std::vector<GdkRectangle> regions;
+    {
+        std::lock_guard<std::mutex> lock(renderer->frameMutex);
+        regions.swap(renderer->damage);
+        renderer->repaintQueued.store(false);
+    }
+    for(const GdkRectangle &r : regions) {
+        gtk_widget_queue_draw_area(renderer->widget, r.x, r.y, r.width, r.height);
+    }
+    return FALSE; // One-shot
+}
+
+void GraphRenderer::drawGraph(cairo_t* cr, const GraphFrameRequest &request, size_t index, double newest) {
+    const GraphSeriesState &state = request.layout[index];
+    const GraphViewport &view = request.view;
+    const TickerData &td = series[state.symbol];
+    const BarSeries &bs = bars[state.symbol];
+    GdkRectangle region = graphRegion(request.width, request.height, request.layout.size(), index);
+    if(view.candles ? bs.bars.empty() : td.values.empty()) {
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+        return;
+    }
+    double width = request.width;
+
+    // Define the drawing area for this graph
+    double graph_y, graphHeight;
+    graphGeometry(request.height, request.layout.size(), index, graph_y, graphHeight);
+
+    // Visible time window; only the samples (or bars) inside it are read
+    double span = graphWindowSeconds(view);
+    double windowEnd = newest - std::max(view.xOffset, 0.0);
+    double windowStart = windowEnd - span;
+    double plotWidth = graphPlotWidth(request.width);
+    std::vector<std::pair<double, double>> &points = decimated; // Reused across sub-graphs
+    size_t firstBar = 0, lastBar = 0;
+
+    // Determine min and max for Y-axis scaling over what is visible
+    bool useLogScale = state.logScale;
+    double localMin = 0.0, localMax = 0.0;
+    double positiveMin = 0.0, positiveMax = 0.0;
+    bool any = false;
+    auto include = [&](double value) {
+        localMin = any ? std::min(localMin, value) : value;
+        localMax = any ? std::max(localMax, value) : value;
+        any = true;
+        if(value > 0.0) {
+            positiveMin = positiveMin > 0.0 ? std::min(positiveMin, value) : value;
+            positiveMax = std::max(positiveMax, value);
+        }
+    };
+    if(view.candles) {
+        visibleBars(bs, windowStart, windowEnd, firstBar, lastBar);
+        for(size_t i = firstBar; i < lastBar; ++i) {
+            include(bs.bars[i].low);
+            include(bs.bars[i].high);
+        }
+        if(!any) {
+            // Panned past this ticker's bars; keep its whole range
+            for(const Bar &bar : bs.bars) {
+                include(bar.low);
+                include(bar.high);
+            }
+        }
+    } else {
+        decimateWindow(td.times, td.values, windowStart, windowEnd, static_cast<size_t>(plotWidth), points);
+        for(const auto &p : points) {
+            if(p.first < windowStart || p.first > windowEnd) continue; // Edge neighbours
+            include(p.second);
+        }
+        if(!any) {
+            // Panned past this ticker's samples; keep its whole range
+            for(double val : td.values) include(val);
+        }
+    }
+    // Handle cases where all values are the same
+    if(localMax - localMin == 0) {
+        localMax += 1.0;
+        localMin -= 1.0;
+    }
+
+    // Apply log-scale if enabled for this ticker
+    if(useLogScale) {
+        if(positiveMax > 0.0) {
+            // Apply log10 transformation
+            localMin = std::log10(positiveMin);
+            localMax = std::log10(positiveMax);
+
+            // Handle cases where all log-transformed values are the same
+            if(localMax - localMin == 0) {
+                localMax += 0.1;
+                localMin -= 0.1;
+            }
+        } else {
+            // If no positive values, disable log scale for this ticker
+            useLogScale = false;
+        }
+    }
+
+    // Add some padding to the Y-axis, apply the zoom and pan, then round it to nice steps
+    double yPadding = 0.05 * (localMax - localMin);
+    double ySpan = (localMax - localMin + 2 * yPadding) / std::max(view.yScale, 1e-6);
+    double yCenter = (localMin + localMax) / 2 + view.yOffset * ySpan;
+    localMin = yCenter - ySpan / 2;
+    localMax = yCenter + ySpan / 2;
+    niceAxisRange(localMin, localMax);
+
+    // Grid and labels come from the cached layer
+    std::unique_ptr<Layer> &layer = layers[state.symbol];
+    if(!layer) layer = std::make_unique<Layer>();
+    if(!layer->surface || layer->region.y != region.y || layer->region.width != region.width ||
+       layer->region.height != region.height || layer->scale != request.scale || layer->index != index ||
+       layer->axisMin != localMin || layer->axisMax != localMax || layer->logScale != useLogScale ||
+       layer->span != span || layer->offset != view.xOffset) {
+        layer->region = region;
+        layer->scale = request.scale;
+        layer->index = index;
+        layer->axisMin = localMin;
+        layer->axisMax = localMax;
+        layer->logScale = useLogScale;
+        layer->span = span;
+        layer->offset = view.xOffset;
+        layer->render(state.symbol, graph_y, graphHeight);
+    }
+    cairo_set_source_surface(cr, layer->surface, region.x, region.y);
+    cairo_paint(cr); // Clipped to the region by the caller
+
+    // Calculate scaling factors
+    PlotMapping map;
+    map.left = margin_left;
+    map.bottom = graph_y + graphHeight;
+    map.windowStart = windowStart;
+    map.xScale = plotWidth / span;
+    map.axisMin = localMin;
+    map.yScale = graphHeight / (localMax - localMin);
+    map.logScale = useLogScale;
+
+    // Lines leaving the plot area (zoomed or panned) are cut at its edges
+    cairo_save(cr);
+    cairo_rectangle(cr, margin_left, graph_y, width - margin_left - margin_right, graphHeight);
+    cairo_clip(cr);
+    if(view.candles) {
+        drawCandles(cr, bs, firstBar, lastBar, map, graphHeight);
+    } else {
+        // Assign a unique color for each ticker
+        double r, g, b;
+        tickerColor(index, r, g, b);
+        cairo_set_source_rgb(cr, r, g, b);
+        cairo_set_line_width(cr, 2.0);
+        for(size_t i = 0; i < points.size(); ++i) {
+            double x = map.x(points[i].first);
+            double y = map.y(points[i].second);
+            if(i == 0) {
+                cairo_move_to(cr, x, y);
+            } else {
+                cairo_line_to(cr, x, y);
+            }
+        }
+        cairo_stroke(cr);
+    }
+    cairo_restore(cr);
+}
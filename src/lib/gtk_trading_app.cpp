@@ -3,91 +3,144 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "../include/gtk_trading_app.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <map>
 #include <sstream>
 #include <gtk/gtk.h>
 #include <iostream>
 
 #include "../include/advanced_graph_view.hpp"
 #include "../include/data_processor.hpp"
-#include "../include/dev_monitor.hpp"
-#include "../include/stock_monitor.hpp"// Constants
-static const int GRAPH_HISTORY_SIZE = 300;
+#include "../include/pipeline.hpp"
+#include "../include/trace.hpp"
+
+// Constants
+// Samples kept per ticker: GRAPH_HISTORY_SECONDS of 30 Hz frames with up
+// to three conflated points each
+static const size_t GRAPH_HISTORY_SIZE = static_cast<size_t>(GRAPH_HISTORY_SECONDS) * 30 * 3;
 
 // Function to update window title based on mode
 static void updateWindowTitle(GtkWindow* window, const AppData& app) {
     std::string baseTitle = "Advanced MBO Terminal";
-    std::string modeLabel = (app.config.dataMode == DataMode::DEV) ? "DEV" : "REAL";
+    std::string modeLabel = dataModeName(app.config.dataMode);
     std::string title = baseTitle + " [" + modeLabel + "]";
     gtk_window_set_title(window, title.c_str());
 }
 
-// Function to initialize DataStreamStats entries
-static void initialize_data_stream(AppData* app, const std::string& streamID) {
-    std::lock_guard<std::mutex> lock(app->statsMutex);
-    auto it = app->dataStreamStats.find(streamID);
-    if(it == app->dataStreamStats.end()) {
-        app->dataStreamStats[streamID] = std::make_shared<DataStreamStats>();
+// Copies the bars of the symbols that traded since the last call, in
+// candlestick mode only. Caller holds dataMutex.
+static void refreshBars(AppData *app) {
+    if(!app->candles) return;
+    for(const auto &kv : app->tickerMap) {
+        app->bars.snapshot(kv.first, app->barIntervalMs, app->barMap[kv.first]);
     }
-    // Reset statistics
-    app->dataStreamStats[streamID]->messagesReceived = 0;
-    app->dataStreamStats[streamID]->errors = 0;
 }
 
-// Callback function to start monitoring
-void start_monitoring(GtkButton *button, gpointer user_data) {
-    AppData *app = static_cast<AppData *>(user_data);
-    if(app->running) return;
-
-    app->stopFlag.store(false);
-    app->requestCount.store(0);
-    app->processor->errorCount.store(0);
-
-    {
-        std::lock_guard<std::mutex> lock(app->dataMutex);
-        for(auto &kv : app->tickerMap) {
-            kv.second.values.clear();
+// Hands the render worker the current layout and the series that changed
+// since the last request; nothing is submitted while the graph is unchanged.
+// Caller holds dataMutex.
+static void submitGraphFrame(AppData *app) {
+    GraphFrameRequest request;
+    request.width = gtk_widget_get_allocated_width(app->drawingArea);
+    request.height = gtk_widget_get_allocated_height(app->drawingArea);
+    request.scale = gtk_widget_get_scale_factor(app->drawingArea);
+    request.view.xScale = app->xScale;
+    request.view.xOffset = app->xOffset;
+    request.view.yScale = app->yScale;
+    request.view.yOffset = app->yOffset;
+    request.view.candles = app->candles;
+    request.view.barIntervalMs = app->barIntervalMs;
+
+    // Versions of the other mode (or interval) mean nothing here, so everything is resent
+    std::map<std::string, uint64_t> submitted;
+    if(app->graphView.candles == request.view.candles && app->graphView.barIntervalMs == request.view.barIntervalMs) {
+        for(const GraphSeriesState &s : app->graphLayout) submitted[s.symbol] = s.version;
+    }
+    for(const auto &kv : app->tickerMap) {
+        const BarSeries* bars = nullptr;
+        if(app->candles) {
+            auto found = app->barMap.find(kv.first);
+            if(found == app->barMap.end() || found->second.bars.empty()) continue;
+            bars = &found->second;
+        } else if(kv.second.values.empty()) {
+            continue;
+        }
+        GraphSeriesState state;
+        state.symbol = kv.first;
+        state.version = bars ? bars->version : kv.second.version;
+        state.logScale = kv.second.logScale || app->globalLogScale;
+        request.layout.push_back(state);
+        auto it = submitted.find(kv.first);
+        if(it == submitted.end() || it->second != state.version) {
+            if(bars) {
+                request.changedBars.emplace(kv.first, *bars);
+            } else {
+                request.changed.emplace(kv.first, kv.second);
+            }
         }
     }
 
-    app->lastTime = g_get_monotonic_time() / 1e6;
-    int activeCores = app->config.totalCores - app->config.reserveCores;
-    if(activeCores <= 0) return;
-
-    for(int i = 0; i < activeCores; ++i) {
-        if(app->config.dataMode == DataMode::DEV) {
-            DevMonitor mon(app->processor);
-            app->threads.emplace_back([mon, app]() mutable {
-                mon.run(app->stopFlag, app->requestCount);
-            });
-        } else {
-            StockMonitor mon(app->config, app->processor);
-            app->threads.emplace_back([mon, app]() mutable {
-                mon.run(app->stopFlag, app->requestCount);
-            });
-        }
+    if(request.layout == app->graphLayout && request.view == app->graphView && request.width == app->graphWidth &&
+       request.height == app->graphHeight && request.scale == app->graphScale) {
+        return;
     }
+    app->graphLayout = request.layout;
+    app->graphView = request.view;
+    app->graphWidth = request.width;
+    app->graphHeight = request.height;
+    app->graphScale = request.scale;
+    app->graphRenderer->submit(std::move(request));
+}
+
+void requestGraphFrame(AppData *app) {
+    if(!app->drawingArea || !app->graphRenderer) return;
+    std::lock_guard<std::mutex> lock(app->dataMutex);
+    refreshBars(app);
+    submitGraphFrame(app);
+}
 
-    // Initialize dataStreamStats for the current mode
-    std::string currentMode = (app->config.dataMode == DataMode::DEV) ? "DEV" : "REAL";
-    initialize_data_stream(app, currentMode);
+// Callback function for the candlestick checkbutton
+void graph_candles_toggled(GtkToggleButton* toggle, gpointer user_data) {
+    AppData* app = static_cast<AppData*>(user_data);
+    app->candles = gtk_toggle_button_get_active(toggle);
+    app->xOffset = 0.0; // Seconds of one mode are not those of the other
+    requestGraphFrame(app);
+}
+
+// Callback function for the bar interval combo box (entries follow config.barIntervals)
+void bar_interval_changed(GtkComboBox* combo, gpointer user_data) {
+    AppData* app = static_cast<AppData*>(user_data);
+    int active = gtk_combo_box_get_active(combo);
+    if(active < 0 || active >= static_cast<int>(app->config.barIntervals.size())) return;
+    app->barIntervalMs = app->config.barIntervals[active];
+    app->xOffset = 0.0;
+    requestGraphFrame(app);
+}
+
+// Callback function to start monitoring
+void start_monitoring(GtkButton *button, gpointer user_data) {
+    AppData *app = static_cast<AppData *>(user_data);
+    if(app->running) return;
 
-    app->running = true;
+    app->lastTime = g_get_monotonic_time() / 1e6;
+    startMonitors(app);
 }
 
 // Callback function to stop monitoring
 void stop_monitoring(GtkButton *button, gpointer user_data) {
     AppData *app = static_cast<AppData *>(user_data);
-    if(!app->running) return;
+    stopMonitors(app);
+}
 
-    app->stopFlag.store(true);
-    for(auto &t : app->threads) {
-        if(t.joinable()) {
-            t.join();
-        }
+// Callback function to write the Chrome trace of all threads
+void dump_trace(GtkButton *button, gpointer user_data) {
+    AppData *app = static_cast<AppData *>(user_data);
+    if(app->config.traceDumpPath.empty()) return;
+    if(!traceDumpChromeJson(app->config.traceDumpPath)) {
+        std::cerr << "Failed to write trace to " << app->config.traceDumpPath << std::endl;
     }
-    app->threads.clear();
-    app->running = false;
 }
 
 // Callback function to toggle data mode
@@ -108,6 +161,23 @@ void ticker_toggle_changed(GtkToggleButton* toggle, gpointer user_data) {
     if(ticker_cstr == nullptr) return;
     std::string ticker = ticker_cstr;
     bool active = gtk_toggle_button_get_active(toggle);
+
+    // Symbol toggles also edit the ingress filter ("_log" toggles share this callback).
+    // Each symbol has a button in two places; keep the other one showing the same state.
+    auto toggles = app->symbolToggles.find(ticker);
+    if(toggles != app->symbolToggles.end()) {
+        for(GtkToggleButton* sibling : toggles->second) {
+            if(sibling == toggle) continue;
+            g_signal_handlers_block_by_func(sibling, reinterpret_cast<gpointer>(ticker_toggle_changed), user_data);
+            gtk_toggle_button_set_active(sibling, active);
+            g_signal_handlers_unblock_by_func(sibling, reinterpret_cast<gpointer>(ticker_toggle_changed), user_data);
+        }
+        if(active) {
+            app->symbolFilter.add(ticker);
+        } else {
+            app->symbolFilter.remove(ticker);
+        }
+    }
     
     std::lock_guard<std::mutex> lock(app->dataMutex);
     if(active) {
@@ -119,6 +189,7 @@ void ticker_toggle_changed(GtkToggleButton* toggle, gpointer user_data) {
         if(app->tickerMap.find(ticker) != app->tickerMap.end()) {
             app->tickerMap.erase(ticker);
         }
+        app->barMap.erase(ticker);
     }
     
     // Trigger a redraw of the graph
@@ -168,6 +239,7 @@ void setup_data_streams_tab(AppData* app, GtkWidget* notebook) {
 
 // Function to update the Data Streams tab in the UI
 gboolean update_data_streams(gpointer user_data) {
+    HF_TRACE_SCOPE("update_data_streams");
     AppData *app = static_cast<AppData *>(user_data);
     if(!app->dataStreamsListStore) return TRUE;
 
@@ -189,29 +261,109 @@ gboolean update_data_streams(gpointer user_data) {
     return TRUE;
 }
 
+// Function to setup the Latency tab
+void setup_latency_tab(AppData* app, GtkWidget* notebook) {
+    GtkWidget *latencyTab = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+
+    GtkWidget *recordChk = gtk_check_button_new_with_label("Record latency");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(recordChk), app->processor->latency.enabled());
+    g_signal_connect(recordChk, "toggled", G_CALLBACK(latency_record_toggled), app);
+    gtk_box_pack_start(GTK_BOX(latencyTab), recordChk, FALSE, FALSE, 5);
+
+    GtkWidget *scrolledWindow = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolledWindow),
+                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_box_pack_start(GTK_BOX(latencyTab), scrolledWindow, TRUE, TRUE, 5);
+
+    // Columns: Stage, Count, p50, p99, p999, Max (nanoseconds)
+    GtkListStore *listStore = gtk_list_store_new(6, G_TYPE_STRING, G_TYPE_UINT64,
+                                                 G_TYPE_UINT64, G_TYPE_UINT64,
+                                                 G_TYPE_UINT64, G_TYPE_UINT64);
+    app->latencyListStore = listStore;
+
+    GtkWidget *treeView = gtk_tree_view_new_with_model(GTK_TREE_MODEL(listStore));
+    gtk_container_add(GTK_CONTAINER(scrolledWindow), treeView);
+
+    const char* titles[] = {"Stage", "Count", "p50 (ns)", "p99 (ns)", "p999 (ns)", "Max (ns)"};
+    for(int i = 0; i < 6; ++i) {
+        GtkCellRenderer *renderer = gtk_cell_renderer_text_new();
+        GtkTreeViewColumn *column = gtk_tree_view_column_new_with_attributes(
+            titles[i], renderer, "text", i, NULL);
+        gtk_tree_view_append_column(GTK_TREE_VIEW(treeView), column);
+    }
+
+    gtk_widget_show_all(latencyTab);
+    gtk_notebook_append_page(GTK_NOTEBOOK(notebook), latencyTab, gtk_label_new("Latency"));
+}
+
+// Callback function for the latency recording checkbutton
+void latency_record_toggled(GtkToggleButton* toggle, gpointer user_data) {
+    AppData* app = static_cast<AppData*>(user_data);
+    app->processor->latency.setEnabled(gtk_toggle_button_get_active(toggle));
+}
+
+// Function to update the Latency tab in the UI
+gboolean update_latency_view(gpointer user_data) {
+    AppData *app = static_cast<AppData *>(user_data);
+    if(!app->latencyListStore) return TRUE;
+
+    gtk_list_store_clear(app->latencyListStore);
+    for(const auto &s : app->processor->latency.summarize()) {
+        GtkTreeIter iter;
+        gtk_list_store_append(app->latencyListStore, &iter);
+        gtk_list_store_set(app->latencyListStore, &iter,
+                           0, latencyStageName(s.stage),
+                           1, static_cast<guint64>(s.count),
+                           2, static_cast<guint64>(s.p50),
+                           3, static_cast<guint64>(s.p99),
+                           4, static_cast<guint64>(s.p999),
+                           5, static_cast<guint64>(s.max),
+                           -1);
+    }
+
+    return TRUE;
+}
+
 // Existing update_ui function
 gboolean update_ui(gpointer user_data) {
+    HF_TRACE_SCOPE("update_ui");
     AppData *app = static_cast<AppData *>(user_data);
 
     if(app->labelStats) {
         std::stringstream ss;
         ss << "Requests: " << app->requestCount.load()
            << " | Errors: " << app->processor->errorCount.load();
-        gtk_label_set_text(GTK_LABEL(app->labelStats), ss.str().c_str());
+        if(app->symbolFilter.enabled()) {
+            ss << " | Filtered: " << app->processor->filteredCount.load();
+        }
+        if(app->graphRenderer) {
+            char frame[32];
+            std::snprintf(frame, sizeof(frame), "%.1f", app->graphRenderer->lastFrameSeconds() * 1e3);
+            ss << "\nFrame: " << frame << " ms | Dropped frames: " << app->graphRenderer->framesDropped();
+        }
+        if(ss.str() != app->statsText) {
+            app->statsText = ss.str();
+            gtk_label_set_text(GTK_LABEL(app->labelStats), app->statsText.c_str());
+        }
     }
 
     {
-        std::lock_guard<std::mutex> lock(app->dataMutex);
-        for(auto &kv : app->tickerMap) {
-            if(kv.second.values.size() > GRAPH_HISTORY_SIZE * 2) {
-                kv.second.values.erase(kv.second.values.begin(),
-                                       kv.second.values.end() - GRAPH_HISTORY_SIZE);
-            }
+        std::unique_lock<std::mutex> lock(app->dataMutex, std::defer_lock);
+        {
+            HF_TRACE_SCOPE("dataMutex wait");
+            lock.lock();
+        }
+        // One interval per updated symbol, however many messages arrived
+        double now = g_get_monotonic_time() / 1e6;
+        app->tickerConflator.drain([app, now](const std::string &symbol, const TickerInterval &interval) {
+            TickerData &td = app->tickerMap[symbol];
+            td.appendInterval(interval, now, GRAPH_HISTORY_SIZE);
+            td.trimBefore(now - GRAPH_HISTORY_SECONDS);
+        });
+        refreshBars(app);
+        if(app->drawingArea && app->graphRenderer) {
+            submitGraphFrame(app);
         }
-    }
-
-    if(app->drawingArea) {
-        gtk_widget_queue_draw(app->drawingArea);
     }
 
     return TRUE;
@@ -2,15 +2,85 @@
 // influx_db_client.cpp
 ////////////////////////////////////////////////////////////////////////////////
 #include "../include/influx_db_client.hpp"
+#include "../include/trace.hpp"
+#include "../include/thread_placement.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <iostream>
+#include <curl/curl.h>
 
 InfluxDBClient::InfluxDBClient(const std::string &url, const std::string &dbName)
-    : serverURL(url), database(dbName)
+    : serverURL(url), database(dbName), output(&std::cout)
 {
 }
 
 InfluxDBClient::~InfluxDBClient()
 {
+    stopBatching();
+}
+
+// Escapes measurement names and tag values (commas, spaces, equals signs)
+static void appendEscapedTag(std::string &out, const std::string &value) {
+    for(char c : value) {
+        if(c == ',' || c == ' ' || c == '=') out += '\\';
+        out += c;
+    }
+}
+
+// Appends a double-quoted string field value
+static void appendQuotedField(std::string &out, const std::string &value) {
+    out += '"';
+    for(char c : value) {
+        if(c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+}
+
+template <typename T>
+static void appendNumber(std::string &out, T value) {
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
+
+void InfluxDBClient::encodeLine(std::string &out,
+                                const std::string &measurement,
+                                const std::string &symbol,
+                                double price,
+                                long long timestamp,
+                                int quantity,
+                                const std::string &side,
+                                const std::string &orderID,
+                                const std::string &attribution,
+                                const std::string &matchID)
+{
+    // order_book,symbol=AAPL,side=buy price=101.25,qty=10i,oid="ID1",attr="BrokerA",mid="MID1" 1700000000000
+    appendEscapedTag(out, measurement);
+    out += ",symbol=";
+    appendEscapedTag(out, symbol);
+    out += ",side=";
+    appendEscapedTag(out, side);
+    out += " price=";
+    appendNumber(out, price);
+    out += ",qty=";
+    appendNumber(out, quantity);
+    out += "i,oid=";
+    appendQuotedField(out, orderID);
+    out += ",attr=";
+    appendQuotedField(out, attribution);
+    out += ",mid=";
+    appendQuotedField(out, matchID);
+    out += ' ';
+    appendNumber(out, timestamp);
+    out += '\n';
+}
+
+void InfluxDBClient::setOutput(std::ostream *stream)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    output = stream;
 }
 
 void InfluxDBClient::write(const std::string &measurement,
@@ -22,18 +92,198 @@ void InfluxDBClient::write(const std::string &measurement,
                            const std::string &orderID,
                            const std::string &attribution,
                            const std::string &matchID)
+{
+    HF_TRACE_SCOPE("db_write");
+    std::unique_lock<std::mutex> lock(writeMutex);
+    linesQueued++;
+    if(batching) {
+        if(maxPendingBytes > 0 && pending.size() >= maxPendingBytes && !makeRoom(lock)) {
+            linesDropped++;
+            return;
+        }
+        encodeLine(pending, measurement, symbol, price, timestamp, quantity,
+                   side, orderID, attribution, matchID);
+        pendingLines++;
+        pendingBytes.store(pending.size(), std::memory_order_release);
+        if(pending.size() >= batchBytes) {
+            flushWait.notify();
+        }
+        return;
+    }
+
+    lineBuffer.clear();
+    encodeLine(lineBuffer, measurement, symbol, price, timestamp, quantity,
+               side, orderID, attribution, matchID);
+    *output << "[INFLUX WRITE db=" << database << "] " << lineBuffer;
+}
+
+void InfluxDBClient::setPendingLimit(size_t maxBytes, OverflowPolicy policy)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    maxPendingBytes = maxBytes;
+    overflowPolicy = policy;
+}
+
+bool InfluxDBClient::makeRoom(std::unique_lock<std::mutex> &lock)
+{
+    switch(overflowPolicy) {
+        case OverflowPolicy::DropNewest:
+            return false;
+        case OverflowPolicy::Block:
+            // Producers stall until the writer swaps the batch out
+            while(batching && !stopRequested && pending.size() >= maxPendingBytes) {
+                lock.unlock();
+                spaceWait.waitUntil([this] {
+                    return pendingBytes.load(std::memory_order_acquire) < maxPendingBytes ||
+                           stopRequested.load(std::memory_order_acquire);
+                }, std::chrono::milliseconds(100));
+                lock.lock();
+            }
+            return batching && !stopRequested;
+        case OverflowPolicy::DropOldest:
+        case OverflowPolicy::Conflate: {
+            // Drop the older half at a line boundary; one line at a time would memmove per write
+            size_t cut = pending.find('\n', pending.size() / 2);
+            cut = cut == std::string::npos ? pending.size() : cut + 1;
+            uint64_t lines = static_cast<uint64_t>(std::count(pending.begin(), pending.begin() + cut, '\n'));
+            pending.erase(0, cut);
+            pendingLines -= lines;
+            linesDropped += lines;
+            pendingBytes.store(pending.size(), std::memory_order_release);
+            return true;
+        }
+    }
+    return true;
+}
+
+void InfluxDBClient::startBatching(bool http, size_t maxBatchBytes, int flushIntervalMs,
+                                   WaitMode writerWait, const std::vector<int> &cpus)
 {
     std::lock_guard<std::mutex> lock(writeMutex);
-    std::cout << "[INFLUX WRITE] meas=" << measurement
-              << " symbol=" << symbol
-              << " price=" << price
-              << " time=" << timestamp
-              << " qty=" << quantity
-              << " side=" << side
-              << " oid=" << orderID
-              << " attr=" << attribution
-              << " mid=" << matchID
-              << " db=" << database
-              << " url=" << serverURL
-              << std::endl;
-}
\ No newline at end of file
+    if(batching) return;
+
+    useHttp = http;
+    batchBytes = maxBatchBytes > 0 ? maxBatchBytes : 1;
+    if(maxPendingBytes > 0) {
+        batchBytes = std::min(batchBytes, maxPendingBytes); // Flush before producers hit the limit
+    }
+    flushMs = flushIntervalMs > 0 ? flushIntervalMs : 1;
+    writerCpus = cpus;
+    flushWait.setMode(writerWait);
+    stopRequested = false;
+    pending.reserve(batchBytes * 2);
+    flushBuffer.reserve(batchBytes * 2);
+
+    if(useHttp) {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        curlHandle = curl_easy_init();
+    }
+
+    batching = true;
+    writerThread = std::thread(&InfluxDBClient::writerLoop, this);
+}
+
+void InfluxDBClient::stopBatching()
+{
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if(!batching) return;
+        stopRequested = true;
+    }
+    flushWait.notify();
+    spaceWait.notify();
+    writerThread.join();
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    batching = false;
+    if(curlHandle) {
+        curl_easy_cleanup(static_cast<CURL*>(curlHandle));
+        curlHandle = nullptr;
+    }
+}
+
+void InfluxDBClient::writerLoop()
+{
+    HF_TRACE_THREAD_NAME("db-writer");
+    if(!writerCpus.empty()) {
+        pinCurrentThread(writerCpus);
+    }
+    std::unique_lock<std::mutex> lock(writeMutex, std::defer_lock);
+    while(true) {
+        // Wait without the lock so spinning writers do not hold up producers
+        flushWait.waitUntil([this] {
+            return stopRequested.load(std::memory_order_acquire) ||
+                   pendingBytes.load(std::memory_order_acquire) >= batchBytes;
+        }, std::chrono::milliseconds(flushMs));
+
+        lock.lock();
+        if(pending.empty()) {
+            bool stop = stopRequested;
+            lock.unlock();
+            if(stop) break;
+            continue;
+        }
+
+        // Swap buffers so producers keep appending while the batch is sent
+        pending.swap(flushBuffer);
+        pendingBytes.store(0, std::memory_order_release);
+        uint64_t lines = pendingLines;
+        pendingLines = 0;
+        lock.unlock();
+        spaceWait.notify();
+
+        bool ok;
+        {
+            HF_TRACE_SCOPE("db_flush");
+            uint64_t begin = readTicks();
+            ok = sendBatch(flushBuffer);
+            flushLatency.record(readTicks() - begin);
+        }
+        if(ok) {
+            linesFlushed += lines;
+            bytesFlushed += flushBuffer.size();
+            batchesFlushed++;
+        } else {
+            flushFailures++;
+        }
+        flushBuffer.clear();
+    }
+}
+
+static size_t discardResponse(char*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+bool InfluxDBClient::sendBatch(const std::string &batch)
+{
+    if(!useHttp) {
+        // output is only replaced via setOutput before batching starts
+        *output << batch;
+        output->flush();
+        return static_cast<bool>(*output);
+    }
+
+    CURL* curl = static_cast<CURL*>(curlHandle);
+    if(!curl) return false;
+
+    std::string url = serverURL + "/write?db=" + database + "&precision=ms";
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, batch.data());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(batch.size()));
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardResponse);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 10000L);
+
+    CURLcode res = curl_easy_perform(curl);
+    if(res != CURLE_OK) {
+        std::cerr << "Influx write failed: " << curl_easy_strerror(res) << std::endl;
+        return false;
+    }
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    if(status < 200 || status >= 300) {
+        std::cerr << "Influx write failed: HTTP " << status << std::endl;
+        return false;
+    }
+    return true;
+}
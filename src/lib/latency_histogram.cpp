@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+// latency_histogram.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/latency_histogram.hpp"
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+const char* latencyStageName(LatencyStage stage) {
+    switch(stage) {
+        case LatencyStage::Frame:   return "frame";
+        case LatencyStage::Parse:   return "parse";
+        case LatencyStage::Stats:   return "stats";
+        case LatencyStage::Ticker:  return "ticker";
+        case LatencyStage::Book:    return "book";
+        case LatencyStage::DbWrite: return "db_write";
+        case LatencyStage::Total:   return "total";
+        default:                    return "unknown";
+    }
+}
+
+static double calibrateTicksPerNanosecond() {
+#if defined(__x86_64__) || defined(__i386__)
+    auto wallStart = std::chrono::steady_clock::now();
+    uint64_t tickStart = readTicks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    uint64_t tickEnd = readTicks();
+    auto wallEnd = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(wallEnd - wallStart).count();
+    if(ns <= 0.0 || tickEnd <= tickStart) return 1.0;
+    return static_cast<double>(tickEnd - tickStart) / ns;
+#else
+    return 1.0;
+#endif
+}
+
+double ticksPerNanosecond() {
+    static const double ratio = calibrateTicksPerNanosecond();
+    return ratio;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if(index < kSubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = (index >> kSubBucketBits) - 1;
+    uint64_t mantissa = static_cast<uint64_t>(index & (kSubBuckets - 1)) + kSubBuckets;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    uint64_t n = count();
+    if(n == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(n));
+    if(target >= n) target = n - 1;
+
+    uint64_t seen = 0;
+    for(int i = 0; i < kBucketCount; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if(seen > target) {
+            // Never report more than the recorded maximum
+            uint64_t upper = bucketUpperBound(i);
+            uint64_t top = max();
+            return upper < top ? upper : top;
+        }
+    }
+    return max();
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    if(n == 0) return 0.0;
+    return static_cast<double>(sum.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+void LatencyHistogram::reset() {
+    for(auto &c : counts) {
+        c.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::nonEmptyBuckets(std::vector<std::pair<uint64_t, uint64_t>> &out) const {
+    for(int i = 0; i < kBucketCount; ++i) {
+        uint64_t c = counts[i].load(std::memory_order_relaxed);
+        if(c != 0) {
+            out.emplace_back(bucketUpperBound(i), c);
+        }
+    }
+}
+
+LatencyRecorder::LatencyRecorder()
+{
+    // Calibrate up front so the first UI refresh doesn't stall
+    ticksPerNanosecond();
+}
+
+std::vector<LatencySummary> LatencyRecorder::summarize() const {
+    const double perNs = ticksPerNanosecond();
+    std::vector<LatencySummary> result;
+    result.reserve(histograms.size());
+    for(size_t i = 0; i < histograms.size(); ++i) {
+        const LatencyHistogram &h = histograms[i];
+        LatencySummary s;
+        s.stage = static_cast<LatencyStage>(i);
+        s.count = h.count();
+        s.p50   = h.percentile(0.50) / perNs;
+        s.p99   = h.percentile(0.99) / perNs;
+        s.p999  = h.percentile(0.999) / perNs;
+        s.max   = h.max() / perNs;
+        s.mean  = h.mean() / perNs;
+        result.push_back(s);
+    }
+    return result;
+}
+
+void LatencyRecorder::reset() {
+    for(auto &h : histograms) {
+        h.reset();
+    }
+}
+
+bool LatencyRecorder::dumpToFile(const std::string &path) const {
+    std::ofstream out(path);
+    if(!out.is_open()) {
+        return false;
+    }
+
+    const double perNs = ticksPerNanosecond();
+    out << "# stage count p50_ns p99_ns p999_ns max_ns mean_ns\n";
+    out << std::fixed << std::setprecision(1);
+    for(const auto &s : summarize()) {
+        out << latencyStageName(s.stage) << ' ' << s.count << ' '
+            << s.p50 << ' ' << s.p99 << ' ' << s.p999 << ' '
+            << s.max << ' ' << s.mean << '\n';
+    }
+
+    out << "\n# stage bucket_upper_ns count\n";
+    std::vector<std::pair<uint64_t, uint64_t>> buckets;
+    for(size_t i = 0; i < histograms.size(); ++i) {
+        buckets.clear();
+        histograms[i].nonEmptyBuckets(buckets);
+        const char* name = latencyStageName(static_cast<LatencyStage>(i));
+        for(const auto &b : buckets) {
+            out << name << ' ' << b.first / perNs << ' ' << b.second << '\n';
+        }
+    }
+    return static_cast<bool>(out);
+}
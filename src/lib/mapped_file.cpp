@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+// mapped_file.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/mapped_file.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string &path, std::string &error) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        error = "cannot stat " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    length = static_cast<size_t>(st.st_size);
+    if(length > 0) {
+        void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED) {
+            error = "cannot map " + path + ": " + std::strerror(errno);
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        base = static_cast<const char*>(addr);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if(base != nullptr) {
+        munmap(const_cast<char*>(base), length);
+    }
+    base = nullptr;
+    length = 0;
+    opened = false;
+}
+
+void MappedFile::adviseSequential() const {
+    if(base != nullptr) {
+        madvise(const_cast<char*>(base), length, MADV_SEQUENTIAL);
+    }
+}
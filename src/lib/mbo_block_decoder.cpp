@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////
+// mbo_block_decoder.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/mbo_block_decoder.hpp"
+#include "../include/mbo_pipeline.hpp"
+#include "../include/numeric_parse.hpp"
+#include <cstring>
+
+static inline bool isJsonSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool isBlank(const char* begin, const char* end) {
+    for(const char* p = begin; p < end; ++p) {
+        if(!isJsonSpace(*p)) return false;
+    }
+    return true;
+}
+
+// String contents that decode to themselves: printable ASCII, no escapes
+static bool isPlainString(const char* begin, const char* end) {
+    for(const char* p = begin; p < end; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if(c < 0x20 || c >= 0x80 || c == '\\') return false;
+    }
+    return true;
+}
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Matches the JSON number grammar
+static bool isJsonNumber(const char* p, const char* end) {
+    if(p < end && *p == '-') ++p;
+    if(p == end) return false;
+    if(*p == '0') {
+        ++p;
+    } else if(isDigit(*p)) {
+        while(p < end && isDigit(*p)) ++p;
+    } else {
+        return false;
+    }
+    if(p < end && *p == '.') {
+        ++p;
+        if(p == end || !isDigit(*p)) return false;
+        while(p < end && isDigit(*p)) ++p;
+    }
+    if(p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if(p < end && (*p == '+' || *p == '-')) ++p;
+        if(p == end || !isDigit(*p)) return false;
+        while(p < end && isDigit(*p)) ++p;
+    }
+    return p == end;
+}
+
+static bool isLiteral(const char* begin, const char* end) {
+    size_t len = static_cast<size_t>(end - begin);
+    return (len == 4 && (std::memcmp(begin, "true", 4) == 0 || std::memcmp(begin, "null", 4) == 0)) ||
+           (len == 5 && std::memcmp(begin, "false", 5) == 0);
+}
+
+// No exponent and at most 19 digits: nlohmann reads it without overflow
+static bool isSafeNumber(const char* begin, const char* end) {
+    if(!isJsonNumber(begin, end)) return false;
+    size_t digits = 0;
+    for(const char* p = begin; p < end; ++p) {
+        if(*p == 'e' || *p == 'E') return false;
+        digits += isDigit(*p);
+    }
+    return digits <= 19;
+}
+
+// Value span of one member, recorded during the walk and decoded afterwards
+struct FieldSpan {
+    const char* begin;
+    const char* end;
+    bool isString;
+};
+
+static const int FIELD_SLOTS = 10; // One per MboField bit
+
+// MboField bit index of a known key, or -1
+static int fieldSlot(const char* key, size_t keyLen) {
+    switch(keyLen) {
+        case 1:
+            switch(key[0]) {
+                case 's': return 1;
+                case 'q': return 3;
+                case 'p': return 4;
+                case 'x': return 5;
+                case 'a': return 7;
+            }
+            break;
+        case 2:
+            if(key[0] == 't' && key[1] == 'm') return 2;
+            if(key[0] == 'i' && key[1] == 'd') return 6;
+            break;
+        case 3:
+            if(std::memcmp(key, "mid", 3) == 0) return 8;
+            if(std::memcmp(key, "nid", 3) == 0) return 9;
+            break;
+        case 4:
+            if(std::memcmp(key, "type", 4) == 0) return 0;
+            break;
+    }
+    return -1;
+}
+
+static const uint32_t NUMERIC_FIELDS = MBO_FIELD_TIMESTAMP | MBO_FIELD_QUANTITY | MBO_FIELD_PRICE;
+
+/*
+ * Checks one member the way parseMboMessage does: string fields take
+ * strings, tm/q/p numbers. Unknown members only need to be valid.
+ */
+static bool acceptField(int slot, bool isString, const char* v, const char* vEnd) {
+    if(slot < 0) return isString || isLiteral(v, vEnd) || isJsonNumber(v, vEnd);
+    return isString == ((NUMERIC_FIELDS & (1u << slot)) == 0);
+}
+
+// Decodes one accepted field into msg
+static bool decodeField(int slot, const FieldSpan &f, MboMessage &msg) {
+    switch(slot) {
+        case 0: msg.type.assign(f.begin, f.end); return true;
+        case 1: msg.symbol.assign(f.begin, f.end); return true;
+        case 2: return parseJsonInt64(f.begin, f.end, msg.timestamp);
+        case 3: return parseJsonInt32(f.begin, f.end, msg.quantity);
+        case 4: return parseJsonPrice(f.begin, f.end, msg.price, msg.priceTicks);
+        case 5: msg.side.assign(f.begin, f.end); return true;
+        case 6: msg.orderID.assign(f.begin, f.end); return true;
+        case 7: msg.attribution.assign(f.begin, f.end); return true;
+        case 8: msg.matchID.assign(f.begin, f.end); return true;
+        case 9: msg.newID.assign(f.begin, f.end); return true;
+    }
+    return false;
+}
+
+bool MboBlockDecoder::decodeObject(const char* data, size_t &k, MboBlockRecord &rec) {
+    const uint32_t* idx = index.data();
+    const size_t n = index.size();
+    auto at = [&](size_t i) { return data[idx[i]]; };
+
+    if(at(k) != '{') return false;
+    rec.begin = idx[k];
+    FieldSpan fields[FIELD_SLOTS];
+    uint32_t seen = 0;
+    const char* prev = data + idx[k] + 1; // First byte after the last token
+    size_t i = k + 1;
+
+    while(true) {
+        // "key" :
+        if(i + 2 >= n || at(i) != '"' || at(i + 1) != '"' || at(i + 2) != ':') return false;
+        const char* key = data + idx[i] + 1;
+        const char* keyEnd = data + idx[i + 1];
+        if(!isBlank(prev, key - 1) || !isPlainString(key, keyEnd) || !isBlank(keyEnd + 1, data + idx[i + 2])) {
+            return false;
+        }
+        prev = data + idx[i + 2] + 1;
+        i += 3;
+        if(i >= n) return false;
+
+        // "string" or a bare number/literal running up to the next , or }
+        bool isString = at(i) == '"';
+        const char* v;
+        const char* vEnd;
+        if(isString) {
+            if(i + 1 >= n || at(i + 1) != '"') return false;
+            v = data + idx[i] + 1;
+            vEnd = data + idx[i + 1];
+            if(!isBlank(prev, v - 1) || !isPlainString(v, vEnd)) return false;
+            prev = vEnd + 1;
+            i += 2;
+            if(i >= n) return false;
+        } else {
+            v = prev;
+            vEnd = data + idx[i];
+            while(v < vEnd && isJsonSpace(*v)) ++v;
+            while(vEnd > v && isJsonSpace(vEnd[-1])) --vEnd;
+            prev = vEnd;
+        }
+
+        char sep = at(i);
+        if((sep != ',' && sep != '}') || !isBlank(prev, data + idx[i])) return false;
+        int slot = fieldSlot(key, static_cast<size_t>(keyEnd - key));
+        if(!acceptField(slot, isString, v, vEnd)) return false;
+        if(slot >= 0) {
+            fields[slot] = FieldSpan{v, vEnd, isString};
+            seen |= 1u << slot;
+        }
+        prev = data + idx[i] + 1;
+        ++i;
+        if(sep == '}') break;
+    }
+    if((seen & MBO_REQUIRED_FIELDS) != MBO_REQUIRED_FIELDS) return false;
+    rec.end = idx[i - 1] + 1;
+    k = i;
+
+    // Unsubscribed symbols are dropped before anything is decoded
+    rec.filtered = admitSymbol && !admitSymbol(fields[1].begin, static_cast<size_t>(fields[1].end - fields[1].begin));
+    if(rec.filtered) return true;
+
+    // Decode only what the type's pipeline reads; numbers it skips still have to be safe to parse
+    MboMessage &msg = rec.msg;
+    msg.type.assign(fields[0].begin, fields[0].end);
+    msg.kind = mboTypeFromTag(msg.type.data(), msg.type.size());
+    uint32_t needed = MBO_FIELDS_NEEDED[static_cast<size_t>(msg.kind)];
+    msg.newID.clear();
+    for(int slot = 1; slot < FIELD_SLOTS; ++slot) {
+        uint32_t bit = 1u << slot;
+        if(!(seen & bit)) continue;
+        if(needed & bit) {
+            if(!decodeField(slot, fields[slot], msg)) return false;
+        } else if((bit & NUMERIC_FIELDS) && !isSafeNumber(fields[slot].begin, fields[slot].end)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t MboBlockDecoder::decode(const char* data, size_t size) {
+    count = 0;
+    buildStructuralIndex(data, size, index, simdLevel);
+    consumedBytes = size;
+
+    const size_t n = index.size();
+    size_t k = 0;
+    while(k < n) {
+        if(count == records.size()) records.emplace_back();
+        size_t start = k;
+        if(decodeObject(data, k, records[count])) {
+            count++;
+            continue;
+        }
+
+        // Not a message this decoder handles: skip the rest of its line
+        uint32_t from = index[start];
+        const char* newline = static_cast<const char*>(std::memchr(data + from, '\n', size - from));
+        if(newline == nullptr) break;
+        uint32_t lineEnd = static_cast<uint32_t>(newline - data);
+        size_t quotes = 0;
+        for(k = start; k < n && index[k] < lineEnd; ++k) {
+            quotes += data[index[k]] == '"';
+        }
+        if(quotes & 1) {
+            // An unterminated string flips the in-string mask for the rest of the block
+            consumedBytes = lineEnd + 1;
+            break;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,212 @@
+////////////////////////////////////////////////////////////////////////////////
+// mbo_message.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/mbo_message.hpp"
+#include "../include/mbo_pipeline.hpp"
+#include "../include/numeric_parse.hpp"
+#include <charconv>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+const char* mboTypeName(MboType type) {
+    for(const MboTypeTag &t : MBO_TYPE_TAGS) {
+        if(t.type == type) return t.tag;
+    }
+    return "unknown";
+}
+
+// Message members, indexed by the bit position of their MboField
+struct MessageField {
+    const char* key;
+    bool numeric;
+};
+
+static const MessageField messageFields[] = {
+    {"type", false}, {"s", false},  {"tm", true}, {"q", true},   {"p", true},
+    {"x", false},    {"id", false}, {"a", false}, {"mid", false}, {"nid", false},
+};
+
+static const int FIELD_COUNT = sizeof(messageFields) / sizeof(messageFields[0]);
+
+// One top-level member as the SAX pass saw it
+struct RawField {
+    enum Kind : uint8_t { Missing, String, Number, Other };
+    Kind kind = Missing;
+    std::string text; // String value, or the text of a number
+};
+
+/*
+ * Collects the known top-level members of one message without building a
+ * DOM. Values of unknown members and anything nested are only validated.
+ */
+class MessageSax : public nlohmann::json_sax<json> {
+public:
+    RawField fields[FIELD_COUNT];
+    bool notObject = false;
+    std::string parseError;
+
+    bool null() override {
+        value(RawField::Other);
+        return true;
+    }
+    bool boolean(bool) override {
+        value(RawField::Other);
+        return true;
+    }
+    bool number_integer(number_integer_t val) override {
+        RawField* f = value(RawField::Number);
+        if(f) integerText(*f, val);
+        return true;
+    }
+    bool number_unsigned(number_unsigned_t val) override {
+        RawField* f = value(RawField::Number);
+        if(f) integerText(*f, val);
+        return true;
+    }
+    bool number_float(number_float_t, const string_t &raw) override {
+        RawField* f = value(RawField::Number);
+        if(f) f->text.assign(raw);
+        return true;
+    }
+    bool string(string_t &val) override {
+        RawField* f = value(RawField::String);
+        if(f) f->text.assign(val);
+        return true;
+    }
+    bool binary(binary_t &) override {
+        value(RawField::Other);
+        return true;
+    }
+    bool start_object(std::size_t) override {
+        if(depth > 0) value(RawField::Other);
+        depth++;
+        return true;
+    }
+    bool key(string_t &val) override {
+        current = -1;
+        if(depth == 1) {
+            for(int i = 0; i < FIELD_COUNT; ++i) {
+                if(val == messageFields[i].key) {
+                    current = i;
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+    bool end_object() override {
+        depth--;
+        return true;
+    }
+    bool start_array(std::size_t) override {
+        if(depth == 0) {
+            notObject = true;
+            return false;
+        }
+        value(RawField::Other);
+        depth++;
+        return true;
+    }
+    bool end_array() override {
+        depth--;
+        return true;
+    }
+    bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &ex) override {
+        parseError = ex.what();
+        return false;
+    }
+
+private:
+    int depth = 0;
+    int current = -1; // Field of the member whose value comes next
+
+    // Marks the value of the current member; the field to fill, if it is a known top-level one
+    RawField* value(RawField::Kind kind) {
+        if(depth == 0) {
+            notObject = true; // A scalar document
+            return nullptr;
+        }
+        if(depth != 1 || current < 0) return nullptr;
+        RawField* f = &fields[current];
+        f->kind = kind;
+        current = -1;
+        return f;
+    }
+
+    // Integers only arrive as values; JSON forbids leading zeros, so their
+    // shortest form is the original text (up to the sign of -0)
+    template <typename T>
+    static void integerText(RawField &f, T val) {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), val);
+        f.text.assign(buf, res.ptr);
+    }
+};
+
+// Decodes one member into msg; false if a number does not fit its field
+static bool decodeField(int slot, RawField &f, MboMessage &msg) {
+    const char* begin = f.text.data();
+    const char* end = begin + f.text.size();
+    switch(slot) {
+        case 1: msg.symbol = std::move(f.text); return true;
+        case 2: return parseJsonInt64(begin, end, msg.timestamp);
+        case 3: return parseJsonInt32(begin, end, msg.quantity);
+        case 4: return parseJsonPrice(begin, end, msg.price, msg.priceTicks);
+        case 5: msg.side = std::move(f.text); return true;
+        case 6: msg.orderID = std::move(f.text); return true;
+        case 7: msg.attribution = std::move(f.text); return true;
+        case 8: msg.matchID = std::move(f.text); return true;
+        case 9: msg.newID = std::move(f.text); return true;
+    }
+    return false;
+}
+
+bool parseMboMessage(const std::string &response, MboMessage &msg, std::string &error) {
+    // One SAX pass: no DOM, only the known members are kept
+    MessageSax sax;
+    if(!json::sax_parse(response, &sax)) {
+        if(sax.notObject) {
+            error = "Invalid JSON structure. Not an object.";
+        } else {
+            error = "JSON parse error: " + sax.parseError;
+        }
+        return false;
+    }
+    if(sax.notObject) {
+        error = "Invalid JSON structure. Not an object.";
+        return false;
+    }
+
+    // Required fields
+    for(int i = 0; i < FIELD_COUNT; ++i) {
+        if(((MBO_REQUIRED_FIELDS >> i) & 1u) && sax.fields[i].kind == RawField::Missing) {
+            error = "Missing required field: " + std::string(messageFields[i].key);
+            return false;
+        }
+    }
+
+    // Strings for string fields, numbers for tm/q/p
+    for(int i = 0; i < FIELD_COUNT; ++i) {
+        RawField::Kind kind = sax.fields[i].kind;
+        if(kind == RawField::Missing) continue; // Only nid is optional
+        if(kind != (messageFields[i].numeric ? RawField::Number : RawField::String)) {
+            error = "Invalid type for field: " + std::string(messageFields[i].key);
+            return false;
+        }
+    }
+
+    // Resolve the type first; the other fields are decoded only if its pipeline reads them
+    msg.type = std::move(sax.fields[0].text);
+    msg.kind = mboTypeFromTag(msg.type.data(), msg.type.size());
+    uint32_t needed = MBO_FIELDS_NEEDED[static_cast<size_t>(msg.kind)];
+    msg.newID.clear();
+    for(int i = 1; i < FIELD_COUNT; ++i) {
+        if(((needed >> i) & 1u) && sax.fields[i].kind != RawField::Missing &&
+           !decodeField(i, sax.fields[i], msg)) {
+            error = "Invalid value for field: " + std::string(messageFields[i].key);
+            return false;
+        }
+    }
+    return true;
+}
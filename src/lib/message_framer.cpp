@@ -0,0 +1,29 @@
+////////////////////////////////////////////////////////////////////////////////
+// message_framer.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/message_framer.hpp"
+
+void MessageFramer::append(const std::string &data) {
+    // Compact once the consumed prefix dominates the buffer
+    if(readPos > 0 && readPos * 2 >= buffer.size()) {
+        buffer.erase(0, readPos);
+        readPos = 0;
+    }
+    buffer += data;
+}
+
+bool MessageFramer::next(std::string &message) {
+    // Look for the start and end of a JSON object
+    auto jsonStart = buffer.find('{', readPos);
+    if(jsonStart == std::string::npos) {
+        return false;
+    }
+    auto jsonEnd = buffer.find('}', jsonStart);
+    if(jsonEnd == std::string::npos) {
+        return false; // No complete JSON object found yet
+    }
+
+    message.assign(buffer, jsonStart, jsonEnd - jsonStart + 1);
+    readPos = jsonEnd + 1;
+    return true;
+}
@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+// metrics.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/metrics.hpp"
+#include <cstdio>
+
+// Exported histogram bucket bounds, in seconds (100 ns .. 1 s)
+static const double HISTOGRAM_BOUNDS[] = {
+    1e-7, 2.5e-7, 5e-7, 1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4,
+    1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0
+};
+static const size_t HISTOGRAM_BOUND_COUNT = sizeof(HISTOGRAM_BOUNDS) / sizeof(HISTOGRAM_BOUNDS[0]);
+
+double secondsPerTick() {
+    return 1.0 / (ticksPerNanosecond() * 1e9);
+}
+
+std::string metricLabel(const std::string &key, const std::string &value) {
+    std::string out = key + "=\"";
+    for(char c : value) {
+        if(c == '\\') out += "\\\\";
+        else if(c == '"') out += "\\\"";
+        else if(c == '\n') out += "\\n";
+        else out += c;
+    }
+    out += '"';
+    return out;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Series& MetricsRegistry::series(const std::string &name, const std::string &help,
+                                                 MetricType type, const std::string &labels) {
+    Family &family = families[name];
+    if(family.series.empty()) {
+        family.help = help;
+        family.type = type;
+    }
+    for(auto &s : family.series) {
+        if(s->labels == labels) return *s;
+    }
+    family.series.push_back(std::make_unique<Series>());
+    family.series.back()->labels = labels;
+    return *family.series.back();
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string &name, const std::string &help,
+                                        const std::string &labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series &s = series(name, help, MetricType::Counter, labels);
+    if(!s.counter) s.counter = std::make_unique<MetricCounter>();
+    return *s.counter;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string &name, const std::string &help,
+                                    const std::string &labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series &s = series(name, help, MetricType::Gauge, labels);
+    if(!s.gauge) s.gauge = std::make_unique<MetricGauge>();
+    return *s.gauge;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const std::string &name, const std::string &help,
+                                            const std::string &labels, double unitSeconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series &s = series(name, help, MetricType::Histogram, labels);
+    if(!s.histogram) s.histogram = std::make_unique<MetricHistogram>(unitSeconds);
+    return *s.histogram;
+}
+
+void MetricsRegistry::counterCallback(const std::string &name, const std::string &help,
+                                      const std::string &labels, std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(mutex);
+    series(name, help, MetricType::Counter, labels).read = std::move(read);
+}
+
+void MetricsRegistry::gaugeCallback(const std::string &name, const std::string &help,
+                                    const std::string &labels, std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(mutex);
+    series(name, help, MetricType::Gauge, labels).read = std::move(read);
+}
+
+void MetricsRegistry::histogramView(const std::string &name, const std::string &help,
+                                    const std::string &labels, const LatencyHistogram* hist,
+                                    double unitSeconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series &s = series(name, help, MetricType::Histogram, labels);
+    s.view = hist;
+    s.unitSeconds = unitSeconds;
+}
+
+static void appendValue(std::string &out, double value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", value);
+    out += buf;
+}
+
+// name{labels,extra} value
+static void appendSample(std::string &out, const std::string &name, const std::string &labels,
+                         const std::string &extra, double value) {
+    out += name;
+    if(!labels.empty() || !extra.empty()) {
+        out += '{';
+        out += labels;
+        if(!labels.empty() && !extra.empty()) out += ',';
+        out += extra;
+        out += '}';
+    }
+    out += ' ';
+    appendValue(out, value);
+    out += '\n';
+}
+
+static void appendHistogram(std::string &out, const std::string &name, const std::string &labels,
+                            const LatencyHistogram &hist, double unitSeconds) {
+    std::vector<std::pair<uint64_t, uint64_t>> buckets;
+    hist.nonEmptyBuckets(buckets);
+
+    // Fold the log-linear buckets into the fixed export bounds (cumulative)
+    uint64_t cumulative[HISTOGRAM_BOUND_COUNT] = {};
+    uint64_t total = 0;
+    for(const auto &b : buckets) {
+        double seconds = static_cast<double>(b.first) * unitSeconds;
+        for(size_t i = 0; i < HISTOGRAM_BOUND_COUNT; ++i) {
+            if(seconds <= HISTOGRAM_BOUNDS[i]) cumulative[i] += b.second;
+        }
+        total += b.second;
+    }
+
+    char le[32];
+    for(size_t i = 0; i < HISTOGRAM_BOUND_COUNT; ++i) {
+        std::snprintf(le, sizeof(le), "le=\"%g\"", HISTOGRAM_BOUNDS[i]);
+        appendSample(out, name + "_bucket", labels, le, static_cast<double>(cumulative[i]));
+    }
+    appendSample(out, name + "_bucket", labels, "le=\"+Inf\"", static_cast<double>(total));
+    appendSample(out, name + "_sum", labels, "", hist.mean() * static_cast<double>(hist.count()) * unitSeconds);
+    appendSample(out, name + "_count", labels, "", static_cast<double>(total));
+}
+
+std::string MetricsRegistry::render() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    out.reserve(16384);
+
+    for(const auto &kv : families) {
+        const std::string &name = kv.first;
+        const Family &family = kv.second;
+        out += "# HELP " + name + " " + family.help + "\n";
+        out += "# TYPE " + name + " ";
+        out += family.type == MetricType::Counter ? "counter" :
+               family.type == MetricType::Gauge ? "gauge" : "histogram";
+        out += '\n';
+
+        for(const auto &s : family.series) {
+            if(s->read) {
+                appendSample(out, name, s->labels, "", s->read());
+            } else if(s->counter) {
+                appendSample(out, name, s->labels, "", static_cast<double>(s->counter->get()));
+            } else if(s->gauge) {
+                appendSample(out, name, s->labels, "", s->gauge->get());
+            } else if(s->histogram) {
+                appendHistogram(out, name, s->labels, s->histogram->data(), s->histogram->unitSeconds());
+            } else if(s->view) {
+                appendHistogram(out, name, s->labels, *s->view, s->unitSeconds);
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////
+// metrics_server.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/metrics_server.hpp"
+#include "../include/metrics.hpp"
+#include "../include/trace.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+MetricsServer::MetricsServer()
+    : listenFd(-1)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start(const std::string &bindAddress, int port) {
+    if(listenFd >= 0) return true;
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0) {
+        std::cerr << "Metrics server: socket() failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if(inet_pton(AF_INET, bindAddress.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Metrics server: invalid bind address " << bindAddress << std::endl;
+        close(fd);
+        return false;
+    }
+    if(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        std::cerr << "Metrics server: cannot listen on " << bindAddress << ":" << port
+                  << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    listenFd = fd;
+    stopRequested.store(false);
+    serverThread = std::thread(&MetricsServer::serve, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if(listenFd < 0) return;
+    stopRequested.store(true);
+    if(serverThread.joinable()) {
+        serverThread.join();
+    }
+    close(listenFd);
+    listenFd = -1;
+}
+
+void MetricsServer::serve() {
+    HF_TRACE_THREAD_NAME("metrics-server");
+    while(!stopRequested.load()) {
+        // Wake up periodically to notice stop()
+        pollfd pfd = {listenFd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 200);
+        if(ready <= 0) continue;
+
+        int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if(clientFd < 0) continue;
+        handleClient(clientFd);
+        close(clientFd);
+    }
+}
+
+// Writes the whole buffer, retrying short writes
+static bool sendAll(int fd, const std::string &data) {
+    size_t sent = 0;
+    while(sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void MetricsServer::handleClient(int clientFd) {
+    // Read the request head (bounded, with a short timeout)
+    std::string request;
+    char buf[1024];
+    while(request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        pollfd pfd = {clientFd, POLLIN, 0};
+        if(poll(&pfd, 1, 1000) <= 0) return;
+        ssize_t n = recv(clientFd, buf, sizeof(buf), 0);
+        if(n <= 0) return;
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    std::string status;
+    std::string body;
+    if(request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 13, "GET /metrics?") == 0) {
+        status = "200 OK";
+        body = MetricsRegistry::instance().render();
+    } else {
+        status = "404 Not Found";
+        body = "Only GET /metrics is served\n";
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n\r\n";
+    sendAll(clientFd, response);
+    sendAll(clientFd, body);
+}
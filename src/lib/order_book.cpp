@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+// order_book.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/order_book.hpp"
+
+// Takes quantity (and the order itself if it is gone) off the level at price
+template <typename Levels>
+static void reduceLevel(Levels &levels, long long price, long long quantity, bool last) {
+    auto it = levels.find(price);
+    if(it == levels.end()) return;
+    it->second.quantity -= quantity;
+    if(last) it->second.orders--;
+    if(it->second.orders <= 0 || it->second.quantity <= 0) levels.erase(it);
+}
+
+// Copies up to count levels, best first
+template <typename Levels>
+static void copyLevels(const Levels &levels, size_t count, std::vector<BookLevel> &out) {
+    out.clear();
+    for(auto it = levels.begin(); it != levels.end() && out.size() < count; ++it) {
+        BookLevel level;
+        level.priceTicks = it->first;
+        level.quantity = it->second.quantity;
+        level.orders = it->second.orders;
+        out.push_back(level);
+    }
+}
+
+void OrderBook::SymbolBook::rest(const Order &order) {
+    Level &level = order.buy ? bids[order.priceTicks] : asks[order.priceTicks];
+    level.quantity += order.quantity;
+    level.orders++;
+}
+
+void OrderBook::SymbolBook::unrest(const Order &order, long long quantity, bool last) {
+    if(order.buy) {
+        reduceLevel(bids, order.priceTicks, quantity, last);
+    } else {
+        reduceLevel(asks, order.priceTicks, quantity, last);
+    }
+}
+
+void OrderBook::SymbolBook::consumeEarly(const std::string &orderID, long long quantity) {
+    if(early.size() >= BOOK_EARLY_LIMIT && early.find(orderID) == early.end()) {
+        early.clear(); // Adds that never came; do not let them pin memory
+    }
+    long long &consumed = early[orderID];
+    if(consumed >= 0) consumed = quantity < 0 ? -1 : consumed + quantity;
+}
+
+OrderBook::OrderBook()
+{
+}
+
+OrderBook::~OrderBook()
+{
+}
+
+OrderBook::SymbolBook* OrderBook::find(const std::string &symbol) const {
+    std::shared_lock<std::shared_mutex> lock(symbolsMutex);
+    auto it = symbols.find(symbol);
+    return it == symbols.end() ? nullptr : it->second.get();
+}
+
+OrderBook::SymbolBook* OrderBook::findOrCreate(const std::string &symbol) {
+    if(SymbolBook* book = find(symbol)) return book;
+
+    std::unique_lock<std::shared_mutex> lock(symbolsMutex);
+    std::unique_ptr<SymbolBook> &book = symbols[symbol];
+    if(!book) book = std::make_unique<SymbolBook>();
+    return book.get();
+}
+
+void OrderBook::add(const std::string &symbol, const std::string &orderID, bool buy, long long priceTicks,
+                    long long quantity) {
+    SymbolBook* book = findOrCreate(symbol);
+    std::lock_guard<std::mutex> lock(book->mutex);
+    if(!book->early.empty()) {
+        auto early = book->early.find(orderID);
+        if(early != book->early.end()) {
+            quantity = early->second < 0 ? 0 : quantity - early->second;
+            book->early.erase(early);
+        }
+    }
+    if(quantity <= 0) return;
+    auto inserted = book->orders.try_emplace(orderID);
+    Order &order = inserted.first->second;
+    if(inserted.second) {
+        liveOrders.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        book->unrest(order, order.quantity, true); // A reused id replaces its order
+    }
+    order.priceTicks = priceTicks;
+    order.quantity = quantity;
+    order.buy = buy;
+    book->rest(order);
+    book->version.fetch_add(1, std::memory_order_release);
+}
+
+void OrderBook::replace(const std::string &symbol, const std::string &orderID, const std::string &newID, bool buy,
+                        long long priceTicks, long long quantity) {
+    SymbolBook* book = findOrCreate(symbol);
+    {
+        std::lock_guard<std::mutex> lock(book->mutex);
+        auto it = book->orders.find(orderID);
+        if(it == book->orders.end()) {
+            unmatched.fetch_add(1, std::memory_order_relaxed);
+            book->consumeEarly(orderID, -1);
+        } else {
+            buy = it->second.buy; // The side of a resting order never changes
+            book->unrest(it->second, it->second.quantity, true);
+            book->orders.erase(it);
+            liveOrders.fetch_sub(1, std::memory_order_relaxed);
+            book->version.fetch_add(1, std::memory_order_release);
+        }
+    }
+    add(symbol, newID, buy, priceTicks, quantity);
+}
+
+void OrderBook::fill(const std::string &symbol, const std::string &orderID, long long quantity) {
+    SymbolBook* book = findOrCreate(symbol);
+    std::lock_guard<std::mutex> lock(book->mutex);
+    auto it = book->orders.find(orderID);
+    if(it == book->orders.end()) {
+        unmatched.fetch_add(1, std::memory_order_relaxed);
+        book->consumeEarly(orderID, quantity);
+        return;
+    }
+    Order &order = it->second;
+    bool last = quantity >= order.quantity;
+    book->unrest(order, last ? order.quantity : quantity, last);
+    if(last) {
+        book->orders.erase(it);
+        liveOrders.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+        order.quantity -= quantity;
+    }
+    book->version.fetch_add(1, std::memory_order_release);
+}
+
+void OrderBook::remove(const std::string &symbol, const std::string &orderID) {
+    SymbolBook* book = findOrCreate(symbol);
+    std::lock_guard<std::mutex> lock(book->mutex);
+    auto it = book->orders.find(orderID);
+    if(it == book->orders.end()) {
+        unmatched.fetch_add(1, std::memory_order_relaxed);
+        book->consumeEarly(orderID, -1);
+        return;
+    }
+    book->unrest(it->second, it->second.quantity, true);
+    book->orders.erase(it);
+    liveOrders.fetch_sub(1, std::memory_order_relaxed);
+    book->version.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t OrderBook::version(const std::string &symbol) const {
+    SymbolBook* book = find(symbol);
+    return book ? book->version.load(std::memory_order_acquire) : 0;
+}
+
+bool OrderBook::depth(const std::string &symbol, size_t levels, BookDepth &out) const {
+    SymbolBook* book = find(symbol);
+    uint64_t current = book ? book->version.load(std::memory_order_acquire) : 0;
+    if(out.version == current) return false;
+    if(!book) {
+        out = BookDepth();
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(book->mutex);
+    out.version = book->version.load(std::memory_order_relaxed);
+    copyLevels(book->bids, levels, out.bids);
+    copyLevels(book->asks, levels, out.asks);
+    return true;
+}
+
+void OrderBook::clear() {
+    std::unique_lock<std::shared_mutex> lock(symbolsMutex);
+    // Books stay so their versions keep counting up and readers see the change
+    for(auto &kv : symbols) {
+        std::lock_guard<std::mutex> bookLock(kv.second->mutex);
+        kv.second->orders.clear();
+        kv.second->early.clear();
+        kv.second->bids.clear();
+        kv.second->asks.clear();
+        kv.second->version.fetch_add(1, std::memory_order_release);
+    }
+    liveOrders.store(0);
+    unmatched.store(0);
+}
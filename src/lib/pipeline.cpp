@@ -0,0 +1,377 @@
+////////////////////////////////////////////////////////////////////////////////
+// pipeline.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/pipeline.hpp"
+#include "../include/data_processor.hpp"
+#include "../include/dev_monitor.hpp"
+#include "../include/stock_monitor.hpp"
+#include "../include/trace.hpp"
+#include "../include/influx_db_client.hpp"
+#include "../include/metrics.hpp"
+#include "../include/capture_file.hpp"
+#include "../include/mapped_file.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+// Function to initialize DataStreamStats entries
+static void initializeDataStream(CoreData* core, const std::string& streamID) {
+    std::shared_ptr<DataStreamStats> stats = core->processor->streamStats(streamID);
+    if(!stats) return;
+    // Reset statistics
+    stats->messagesReceived = 0;
+    stats->errors = 0;
+}
+
+/*
+ * Replays are deterministic: a single DevMonitor reads the capture in file
+ * order, so every run sees identical input in an identical order.
+ */
+static bool startReplay(CoreData* core) {
+    auto capture = std::make_shared<CaptureReader>();
+    std::string error;
+    if(!capture->open(core->config.replayFile, error)) {
+        std::cerr << "Replay failed: " << error << std::endl;
+        return false;
+    }
+    uint64_t first = core->config.replayStart > 0 ? static_cast<uint64_t>(core->config.replayStart) : 0;
+    if(!capture->seek(first)) {
+        std::cerr << "Replay failed: " << core->config.replayFile << " has only "
+                  << capture->recordCount() << " records" << std::endl;
+        return false;
+    }
+    std::cerr << "Replaying records " << first << ".." << capture->recordCount() << " of " << core->config.replayFile
+              << (capture->indexed() ? "" : " (no index, capture was not closed cleanly)") << std::endl;
+
+    core->activeMonitors.store(1);
+    DevMonitor mon(core->processor);
+    double speed = core->config.replaySpeed;
+    core->threads.emplace_back([mon, capture, speed, core]() mutable {
+        HF_TRACE_THREAD_NAME("replay-monitor");
+        core->placement.pin(ThreadRole::Monitor, 0);
+        mon.replay(*capture, speed, UINT64_MAX, "REPLAY", core->stopFlag, core->requestCount);
+        core->activeMonitors--;
+    });
+
+    initializeDataStream(core, dataModeName(core->config.dataMode));
+    core->running = true;
+    return true;
+}
+
+/*
+ * Bulk load: the input file is mapped once and split into one chunk per
+ * monitor at record boundaries (lines for NDJSON, index ranges for a
+ * capture), so framing and parsing run in parallel. Order is only kept
+ * within a chunk; use REPLAY when the original order matters.
+ */
+static bool startFileMonitors(CoreData* core, int workers) {
+    auto input = std::make_shared<MappedFile>();
+    std::string error;
+    if(!input->open(core->config.inputFile, error)) {
+        std::cerr << "DEV input failed: " << error << std::endl;
+        return false;
+    }
+    input->adviseSequential();
+
+    if(isCaptureData(input->data(), input->size())) {
+        // Each monitor maps the capture itself and replays its share of the records unpaced
+        CaptureReader probe;
+        if(!probe.open(core->config.inputFile, error)) {
+            std::cerr << "DEV input failed: " << error << std::endl;
+            return false;
+        }
+        uint64_t records = probe.recordCount();
+        core->activeMonitors.store(workers);
+        for(int i = 0; i < workers; ++i) {
+            uint64_t first = records * i / workers;
+            uint64_t last = records * (i + 1) / workers;
+            DevMonitor mon(core->processor);
+            std::string path = core->config.inputFile;
+            core->threads.emplace_back([mon, path, first, last, core, i]() mutable {
+                HF_TRACE_THREAD_NAME("file-monitor");
+                core->placement.pin(ThreadRole::Monitor, i);
+                CaptureReader capture;
+                std::string err;
+                if(capture.open(path, err) && capture.seek(first)) {
+                    mon.replay(capture, 0.0, last - first, "DEV", core->stopFlag, core->requestCount);
+                }
+                core->activeMonitors--;
+            });
+        }
+        return true;
+    }
+
+    // NDJSON: cut at the first newline after each even split point
+    const char* data = input->data();
+    const char* end = data + input->size();
+    const char* chunkBegin = data;
+    core->activeMonitors.store(workers);
+    for(int i = 0; i < workers; ++i) {
+        const char* chunkEnd = end;
+        if(i + 1 < workers) {
+            const char* split = data + input->size() * (i + 1) / workers;
+            if(split < chunkBegin) split = chunkBegin;
+            const char* newline = static_cast<const char*>(std::memchr(split, '\n', end - split));
+            chunkEnd = newline ? newline + 1 : end;
+        }
+        DevMonitor mon(core->processor);
+        core->threads.emplace_back([mon, input, chunkBegin, chunkEnd, core, i]() mutable {
+            HF_TRACE_THREAD_NAME("file-monitor");
+            core->placement.pin(ThreadRole::Monitor, i);
+            mon.runRange(chunkBegin, chunkEnd, core->stopFlag, core->requestCount);
+            core->activeMonitors--;
+        });
+        chunkBegin = chunkEnd;
+    }
+    return true;
+}
+
+/*
+ * Split DEV ingest: one reader frames stdin into a bounded queue and
+ * `workers` threads validate and process from it. The queue's policy
+ * decides what happens when the workers fall behind.
+ */
+static void startQueuedMonitors(CoreData* core, int workers) {
+    const Config &cfg = core->config;
+    BoundedQueue<std::string>::KeyFunction symbolKey = [](const std::string &raw) {
+        const char* symbol;
+        size_t length;
+        return scanSymbolField(raw.data(), raw.size(), symbol, length) ? std::string(symbol, length) : std::string();
+    };
+    auto queue = std::make_shared<BoundedQueue<std::string>>(
+        static_cast<size_t>(cfg.ingestQueue), cfg.ingestQueuePolicy, cfg.ingestQueueWait, symbolKey);
+    core->ingestQueue = queue;
+
+    std::string label = metricLabel("queue", "ingest");
+    MetricsRegistry &reg = MetricsRegistry::instance();
+    reg.counterCallback("hf_queue_pushed_total", "Items accepted by a bounded queue", label,
+                        [queue] { return static_cast<double>(queue->pushed.load()); });
+    reg.counterCallback("hf_queue_dropped_total", "Items a bounded queue dropped or conflated", label,
+                        [queue] { return static_cast<double>(queue->dropped.load()); });
+    reg.gaugeCallback("hf_queue_depth", "Items waiting in a bounded queue", label,
+                      [queue] { return static_cast<double>(queue->size()); });
+
+    core->activeMonitors.store(workers + 1);
+    DevMonitor reader(core->processor);
+    core->threads.emplace_back([reader, queue, core]() mutable {
+        HF_TRACE_THREAD_NAME("dev-reader");
+        core->placement.pin(ThreadRole::Monitor, 0);
+        reader.runReader(*queue, core->stopFlag);
+        core->activeMonitors--;
+    });
+    for(int i = 0; i < workers; ++i) {
+        DevMonitor mon(core->processor);
+        core->threads.emplace_back([mon, queue, core, i]() mutable {
+            HF_TRACE_THREAD_NAME("dev-worker");
+            core->placement.pin(ThreadRole::Monitor, i + 1);
+            mon.runWorker(*queue, core->stopFlag, core->requestCount);
+            core->activeMonitors--;
+        });
+    }
+}
+
+bool startMonitors(CoreData* core) {
+    if(core->running) return false;
+
+    core->stopFlag.store(false);
+    core->requestCount.store(0);
+    core->processor->errorCount.store(0);
+    core->processor->filteredCount.store(0);
+    core->processor->latency.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(core->dataMutex);
+        for(auto &kv : core->tickerMap) {
+            kv.second.clear();
+        }
+    }
+    core->tickerConflator.reset();
+    core->bars.reset(core->config.barIntervals);
+    core->book.clear();
+    core->book.setEnabled(core->config.orderBook);
+
+    if(core->config.dataMode == DataMode::REPLAY) {
+        return startReplay(core);
+    }
+
+    int activeCores = core->config.totalCores - core->config.reserveCores;
+    if(activeCores <= 0) return false;
+
+    if(!core->config.captureFile.empty() && !core->capture.open(core->config.captureFile)) {
+        std::cerr << "Capture disabled for this run" << std::endl;
+    }
+
+    if(core->config.dataMode == DataMode::DEV && !core->config.inputFile.empty()) {
+        if(!startFileMonitors(core, activeCores)) {
+            core->capture.close();
+            return false;
+        }
+        initializeDataStream(core, dataModeName(core->config.dataMode));
+        core->running = true;
+        return true;
+    }
+
+    if(core->config.dataMode == DataMode::DEV && core->config.ingestQueue > 0) {
+        startQueuedMonitors(core, activeCores);
+        initializeDataStream(core, dataModeName(core->config.dataMode));
+        core->running = true;
+        return true;
+    }
+
+    core->activeMonitors.store(activeCores);
+    for(int i = 0; i < activeCores; ++i) {
+        if(core->config.dataMode == DataMode::DEV) {
+            DevMonitor mon(core->processor);
+            core->threads.emplace_back([mon, core, i]() mutable {
+                HF_TRACE_THREAD_NAME("dev-monitor");
+                core->placement.pin(ThreadRole::Monitor, i);
+                mon.run(core->stopFlag, core->requestCount);
+                core->activeMonitors--;
+            });
+        } else {
+            StockMonitor mon(core->config, core->processor);
+            core->threads.emplace_back([mon, core, i]() mutable {
+                HF_TRACE_THREAD_NAME("stock-monitor");
+                core->placement.pin(ThreadRole::Monitor, i);
+                mon.run(core->stopFlag, core->requestCount);
+                core->activeMonitors--;
+            });
+        }
+    }
+
+    // Initialize dataStreamStats for the current mode
+    initializeDataStream(core, dataModeName(core->config.dataMode));
+
+    core->running = true;
+    return true;
+}
+
+void planThreadPlacement(CoreData* core, bool dbWriter) {
+    if(!core->config.threadPinning) return;
+
+    std::vector<int> allowed;
+    if(!parseCpuList(core->config.pinCpus, allowed)) {
+        std::cerr << "Ignoring malformed pin_cpus: " << core->config.pinCpus << std::endl;
+        allowed.clear();
+    }
+    int monitors = core->config.dataMode == DataMode::REPLAY
+                       ? 1 : std::max(core->config.totalCores - core->config.reserveCores, 0);
+    if(core->config.dataMode == DataMode::DEV && core->config.inputFile.empty() && core->config.ingestQueue > 0) {
+        monitors++; // The queue reader
+    }
+    core->placement.plan(readCpuTopology(), allowed, core->config.reserveCores, monitors, dbWriter);
+    core->placement.report(std::cerr);
+    core->placement.pin(ThreadRole::Main);
+}
+
+bool stopMonitors(CoreData* core, int joinTimeoutMs) {
+    if(!core->running) return true;
+
+    core->stopFlag.store(true);
+    if(core->ingestQueue) {
+        core->ingestQueue->close(); // Wakes a reader blocked on a full queue
+    }
+
+    bool joined = true;
+    if(joinTimeoutMs >= 0) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(joinTimeoutMs);
+        while(core->activeMonitors.load() > 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        joined = core->activeMonitors.load() == 0;
+    }
+
+    for(auto &t : core->threads) {
+        if(!t.joinable()) continue;
+        if(joined) {
+            t.join();
+        } else {
+            t.detach();
+        }
+    }
+    core->threads.clear();
+    core->running = false;
+
+    // Write the capture footer now: hf_server leaves through _Exit when monitors were
+    // abandoned, and record() from one still running is a no-op once closed
+    core->capture.close();
+
+    // Persist the latency histograms of this run
+    if(core->processor->latency.enabled() && !core->config.latencyDumpPath.empty()) {
+        if(!core->processor->latency.dumpToFile(core->config.latencyDumpPath)) {
+            std::cerr << "Failed to write latency histograms to "
+                      << core->config.latencyDumpPath << std::endl;
+        }
+    }
+
+#ifdef HF_ENABLE_TRACE
+    if(!core->config.traceDumpPath.empty() && !traceDumpChromeJson(core->config.traceDumpPath)) {
+        std::cerr << "Failed to write trace to " << core->config.traceDumpPath << std::endl;
+    }
+#endif
+    return joined;
+}
+
+void registerPipelineMetrics(CoreData* core) {
+    MetricsRegistry &reg = MetricsRegistry::instance();
+
+    // Monitors
+    reg.counterCallback("hf_requests_total", "Messages handed to the processor by the monitors", "",
+                        [core] { return static_cast<double>(core->requestCount.load()); });
+    reg.gaugeCallback("hf_monitors_active", "Monitor threads currently running", "",
+                      [core] { return static_cast<double>(core->activeMonitors.load()); });
+
+    // Processor
+    DataProcessor* processor = core->processor.get();
+    reg.counterCallback("hf_processor_errors_total", "Messages rejected by the processor", "",
+                        [processor] { return static_cast<double>(processor->errorCount.load()); });
+    reg.counterCallback("hf_debug_logs_dropped_total", "Oldest debug log entries discarded to bound memory", "",
+                        [processor] { return static_cast<double>(processor->debugLogsDropped.load()); });
+    reg.counterCallback("hf_filtered_messages_total", "Messages dropped at ingress for an unsubscribed symbol", "",
+                        [processor] { return static_cast<double>(processor->filteredCount.load()); });
+    for(size_t i = 0; i < MBO_TYPE_COUNT; ++i) {
+        reg.counterCallback("hf_messages_by_type_total", "Processed messages per MBO type",
+                            metricLabel("type", mboTypeName(static_cast<MboType>(i))),
+                            [processor, i] { return static_cast<double>(processor->typeCounts[i].load()); });
+    }
+    reg.counterCallback("hf_bar_late_trades_total", "Fills older than a symbol's bar history, left out of a bar", "",
+                        [core] { return static_cast<double>(core->bars.lateTrades.load()); });
+    reg.gaugeCallback("hf_book_orders", "Orders resting in the order books", "",
+                      [core] { return static_cast<double>(core->book.liveOrders.load()); });
+    reg.counterCallback("hf_book_unmatched_events_total", "Book events that arrived before the add of their order", "",
+                        [core] { return static_cast<double>(core->book.unmatched.load()); });
+    for(int i = 0; i < static_cast<int>(LatencyStage::Count); ++i) {
+        LatencyStage stage = static_cast<LatencyStage>(i);
+        reg.histogramView("hf_stage_latency_seconds", "Ingest path time per stage",
+                          metricLabel("stage", latencyStageName(stage)),
+                          &processor->latency.histogram(stage), secondsPerTick());
+    }
+
+    // Storage writer
+    InfluxDBClient* db = core->dbClient.get();
+    reg.counterCallback("hf_db_lines_queued_total", "Line-protocol records handed to the writer", "",
+                        [db] { return static_cast<double>(db->linesQueued.load()); });
+    reg.counterCallback("hf_db_lines_flushed_total", "Records successfully flushed to storage", "",
+                        [db] { return static_cast<double>(db->linesFlushed.load()); });
+    reg.counterCallback("hf_db_bytes_flushed_total", "Bytes successfully flushed to storage", "",
+                        [db] { return static_cast<double>(db->bytesFlushed.load()); });
+    reg.counterCallback("hf_db_batches_flushed_total", "Batches successfully flushed to storage", "",
+                        [db] { return static_cast<double>(db->batchesFlushed.load()); });
+    reg.counterCallback("hf_db_flush_failures_total", "Batches that failed to flush", "",
+                        [db] { return static_cast<double>(db->flushFailures.load()); });
+    reg.counterCallback("hf_db_lines_dropped_total", "Records discarded because the pending batch was full", "",
+                        [db] { return static_cast<double>(db->linesDropped.load()); });
+    reg.histogramView("hf_db_flush_seconds", "Time to send one batch to storage", "",
+                      &db->flushLatency, secondsPerTick());
+
+    // Session capture
+    CaptureWriter* capture = &core->capture;
+    reg.counterCallback("hf_capture_records_total", "Inbound messages written to the capture file", "",
+                        [capture] { return static_cast<double>(capture->recordsCaptured.load()); });
+    reg.counterCallback("hf_capture_bytes_total", "Payload bytes written to the capture file", "",
+                        [capture] { return static_cast<double>(capture->bytesCaptured.load()); });
+    reg.counterCallback("hf_capture_write_failures_total", "Capture buffers that failed to write", "",
+                        [capture] { return static_cast<double>(capture->writeFailures.load()); });
+}
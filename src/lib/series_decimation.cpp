@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////
+// series_decimation.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/series_decimation.hpp"
+#include <algorithm>
+
+void decimateMinMax(const std::vector<double> &values, size_t buckets, std::vector<double> &out) {
+    out.clear();
+    const size_t n = values.size();
+    if(buckets == 0 || n <= buckets * 2) {
+        out.assign(values.begin(), values.end());
+        return;
+    }
+
+    out.reserve(buckets * 2);
+    for(size_t b = 0; b < buckets; ++b) {
+        size_t begin = b * n / buckets;
+        size_t end = (b + 1) * n / buckets;
+        size_t minIdx = begin;
+        size_t maxIdx = begin;
+        for(size_t i = begin + 1; i < end; ++i) {
+            if(values[i] < values[minIdx]) minIdx = i;
+            if(values[i] > values[maxIdx]) maxIdx = i;
+        }
+        if(minIdx == maxIdx) {
+            out.push_back(values[minIdx]);
+        } else if(minIdx < maxIdx) {
+            out.push_back(values[minIdx]);
+            out.push_back(values[maxIdx]);
+        } else {
+            out.push_back(values[maxIdx]);
+            out.push_back(values[minIdx]);
+        }
+    }
+}
+
+void decimateWindow(const std::vector<double> &times, const std::vector<double> &values,
+                    double t0, double t1, size_t columns, std::vector<std::pair<double, double>> &out) {
+    out.clear();
+    const size_t n = std::min(times.size(), values.size());
+    if(n == 0 || !(t1 > t0)) return;
+
+    size_t begin = std::lower_bound(times.begin(), times.begin() + n, t0) - times.begin();
+    size_t end = std::upper_bound(times.begin() + begin, times.begin() + n, t1) - times.begin();
+    if(begin > 0) out.emplace_back(times[begin - 1], values[begin - 1]);
+
+    if(columns == 0 || end - begin <= columns * 2) {
+        for(size_t i = begin; i < end; ++i) out.emplace_back(times[i], values[i]);
+    } else {
+        const double perSecond = static_cast<double>(columns) / (t1 - t0);
+        auto sliceOf = [&](size_t i) {
+            return std::min(static_cast<size_t>((times[i] - t0) * perSecond), columns - 1);
+        };
+        size_t i = begin;
+        while(i < end) {
+            size_t slice = sliceOf(i);
+            size_t minIdx = i;
+            size_t maxIdx = i;
+            for(++i; i < end && sliceOf(i) == slice; ++i) {
+                if(values[i] < values[minIdx]) minIdx = i;
+                if(values[i] > values[maxIdx]) maxIdx = i;
+            }
+            size_t a = std::min(minIdx, maxIdx);
+            size_t b = std::max(minIdx, maxIdx);
+            out.emplace_back(times[a], values[a]);
+            if(b != a) out.emplace_back(times[b], values[b]);
+        }
+    }
+
+    if(end < n) out.emplace_back(times[end], values[end]);
+}
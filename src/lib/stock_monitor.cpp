@@ -60,7 +60,11 @@ void StockMonitor::run(std::atomic<bool> &stopFlag, std::atomic<int> &requestCou
             };
 
             // Process the response
-            dataProcessor->processResponse(response.dump(), "REAL");
+            std::string raw = response.dump();
+            dataProcessor->captureInbound(raw);
+            if(dataProcessor->admitSymbol(raw.data(), raw.size())) {
+                dataProcessor->processResponse(raw, "REAL");
+            }
 
             requestCount++;
             if(stopFlag.load()) break;
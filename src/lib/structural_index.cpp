@@ -0,0 +1,253 @@
+////////////////////////////////////////////////////////////////////////////////
+// structural_index.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/structural_index.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HF_X86_SIMD 1
+#endif
+
+const char* simdLevelName(SimdLevel level) {
+    switch(level) {
+        case SimdLevel::AVX2:  return "avx2";
+        case SimdLevel::SSE42: return "sse4.2";
+        default:               return "scalar";
+    }
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef HF_X86_SIMD
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("pclmul")) return SimdLevel::AVX2;
+        if(__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul")) return SimdLevel::SSE42;
+        return SimdLevel::Scalar;
+    }();
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// String state carried from one 64-byte block to the next
+struct ScanState {
+    uint64_t prevEscaped = 0;  // first byte of the next block is escaped
+    uint64_t prevInString = 0; // all ones if the previous block ended inside a string
+};
+
+/*
+ * Bits of characters escaped by a backslash. Runs of backslashes escape
+ * alternately, so only odd-length runs escape the following character;
+ * the run parity is found with one add per block (as in simdjson).
+ */
+static inline uint64_t findEscaped(uint64_t backslash, ScanState &st) {
+    if(backslash == 0) {
+        uint64_t escaped = st.prevEscaped;
+        st.prevEscaped = 0;
+        return escaped;
+    }
+    backslash &= ~st.prevEscaped;
+    uint64_t followsEscape = (backslash << 1) | st.prevEscaped;
+    const uint64_t evenBits = 0x5555555555555555ULL;
+    uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+    uint64_t sequencesStartingOnEvenBits;
+    st.prevEscaped = __builtin_add_overflow(oddSequenceStarts, backslash, &sequencesStartingOnEvenBits);
+    uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+    return (evenBits ^ invertMask) & followsEscape;
+}
+
+static inline uint64_t prefixXorScalar(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Turns the unescaped-quote prefix XOR into the structural bits of one block
+static inline uint64_t structuralBits(uint64_t quotes, uint64_t quoteXor, uint64_t ops, ScanState &st) {
+    uint64_t inString = quoteXor ^ st.prevInString;
+    st.prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+    return (ops & ~inString) | quotes;
+}
+
+/*
+ * Writes the offsets of the set bits. Eight slots are written per round
+ * whether or not they are used, which keeps the common case branch-free;
+ * dst must have room for 64 entries.
+ */
+static inline uint32_t* emitOffsets(uint32_t* dst, uint64_t bits, uint32_t base) {
+    if(bits == 0) return dst;
+    int cnt = __builtin_popcountll(bits);
+    uint32_t* p = dst;
+    do {
+        for(int j = 0; j < 8; ++j) {
+            p[j] = base + static_cast<uint32_t>(__builtin_ctzll(bits | (1ULL << 63)));
+            bits &= bits - 1;
+        }
+        p += 8;
+    } while(bits != 0);
+    return dst + cnt;
+}
+
+/*
+ * Output growth shared by all levels: out is kept large enough for one
+ * more block of offsets and trimmed to the written count at the end.
+ */
+struct IndexOutput {
+    std::vector<uint32_t> &out;
+    size_t count = 0;
+
+    explicit IndexOutput(std::vector<uint32_t> &o, size_t inputSize) : out(o) {
+        out.clear();
+        out.resize(inputSize / 8 + 64);
+    }
+    uint32_t* reserveBlock() {
+        if(count + 64 > out.size()) out.resize(out.size() * 2);
+        return out.data() + count;
+    }
+    void commit(uint32_t* end) { count = static_cast<size_t>(end - out.data()); }
+    ~IndexOutput() { out.resize(count); }
+};
+
+// Copies the last partial block into a whitespace-padded buffer
+static inline const char* padTail(const char* data, size_t size, size_t offset, char (&tail)[64]) {
+    std::memset(tail, ' ', sizeof(tail));
+    std::memcpy(tail, data + offset, size - offset);
+    return tail;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar
+////////////////////////////////////////////////////////////////////////////////
+
+enum : uint8_t { CLASS_QUOTE = 1, CLASS_BACKSLASH = 2, CLASS_OP = 4 };
+
+struct ClassTable {
+    uint8_t table[256] = {};
+    ClassTable() {
+        table[static_cast<uint8_t>('"')] = CLASS_QUOTE;
+        table[static_cast<uint8_t>('\\')] = CLASS_BACKSLASH;
+        for(char c : {'{', '}', '[', ']', ':', ','}) table[static_cast<uint8_t>(c)] = CLASS_OP;
+    }
+};
+static const ClassTable classTable;
+
+static inline void classifyScalar(const char* p, uint64_t &quote, uint64_t &backslash, uint64_t &ops) {
+    quote = backslash = ops = 0;
+    for(int i = 0; i < 64; ++i) {
+        uint8_t c = classTable.table[static_cast<uint8_t>(p[i])];
+        quote |= static_cast<uint64_t>(c & CLASS_QUOTE) << i;
+        backslash |= static_cast<uint64_t>((c & CLASS_BACKSLASH) >> 1) << i;
+        ops |= static_cast<uint64_t>((c & CLASS_OP) >> 2) << i;
+    }
+}
+
+static bool indexScalar(const char* data, size_t size, std::vector<uint32_t> &out) {
+    IndexOutput output(out, size);
+    ScanState st;
+    char tail[64];
+    for(size_t i = 0; i < size; i += 64) {
+        const char* p = i + 64 <= size ? data + i : padTail(data, size, i, tail);
+        uint64_t quote, backslash, ops;
+        classifyScalar(p, quote, backslash, ops);
+        quote &= ~findEscaped(backslash, st);
+        uint64_t bits = structuralBits(quote, prefixXorScalar(quote), ops, st);
+        output.commit(emitOffsets(output.reserveBlock(), bits, static_cast<uint32_t>(i)));
+    }
+    return st.prevInString == 0;
+}
+
+#ifdef HF_X86_SIMD
+
+__attribute__((target("pclmul")))
+static inline uint64_t prefixXorClmul(uint64_t bits) {
+    __m128i all = _mm_set1_epi8(static_cast<char>(0xFF));
+    __m128i res = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(bits)), all, 0);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(res));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SSE4.2: four 16-byte lanes per block
+////////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("sse4.2")))
+static inline void classify16(__m128i v, uint64_t shift, uint64_t &quote, uint64_t &backslash, uint64_t &ops) {
+    // '{'|0x20 == '{' also matches '[', and '}'|0x20 == '}' also matches ']'
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i op = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+    quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))))) << shift;
+    backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))))) << shift;
+    ops |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(op))) << shift;
+}
+
+__attribute__((target("sse4.2,pclmul")))
+static bool indexSse42(const char* data, size_t size, std::vector<uint32_t> &out) {
+    IndexOutput output(out, size);
+    ScanState st;
+    char tail[64];
+    for(size_t i = 0; i < size; i += 64) {
+        const char* p = i + 64 <= size ? data + i : padTail(data, size, i, tail);
+        uint64_t quote = 0, backslash = 0, ops = 0;
+        for(int lane = 0; lane < 4; ++lane) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + lane * 16));
+            classify16(v, static_cast<uint64_t>(lane * 16), quote, backslash, ops);
+        }
+        quote &= ~findEscaped(backslash, st);
+        uint64_t bits = structuralBits(quote, prefixXorClmul(quote), ops, st);
+        output.commit(emitOffsets(output.reserveBlock(), bits, static_cast<uint32_t>(i)));
+    }
+    return st.prevInString == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2: two 32-byte lanes per block
+////////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx2")))
+static inline void classify32(__m256i v, uint64_t shift, uint64_t &quote, uint64_t &backslash, uint64_t &ops) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i op = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+    quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))))) << shift;
+    backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))))) << shift;
+    ops |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(op))) << shift;
+}
+
+__attribute__((target("avx2,pclmul")))
+static bool indexAvx2(const char* data, size_t size, std::vector<uint32_t> &out) {
+    IndexOutput output(out, size);
+    ScanState st;
+    char tail[64];
+    for(size_t i = 0; i < size; i += 64) {
+        const char* p = i + 64 <= size ? data + i : padTail(data, size, i, tail);
+        uint64_t quote = 0, backslash = 0, ops = 0;
+        classify32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), 0, quote, backslash, ops);
+        classify32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), 32, quote, backslash, ops);
+        quote &= ~findEscaped(backslash, st);
+        uint64_t bits = structuralBits(quote, prefixXorClmul(quote), ops, st);
+        output.commit(emitOffsets(output.reserveBlock(), bits, static_cast<uint32_t>(i)));
+    }
+    return st.prevInString == 0;
+}
+
+#endif // HF_X86_SIMD
+
+bool buildStructuralIndex(const char* data, size_t size, std::vector<uint32_t> &out, SimdLevel level) {
+    // Never run code the CPU cannot execute, whatever the caller asked for
+    if(static_cast<int>(level) > static_cast<int>(detectSimdLevel())) {
+        level = detectSimdLevel();
+    }
+#ifdef HF_X86_SIMD
+    if(level == SimdLevel::AVX2) return indexAvx2(data, size, out);
+    if(level == SimdLevel::SSE42) return indexSse42(data, size, out);
+#endif
+    return indexScalar(data, size, out);
+}
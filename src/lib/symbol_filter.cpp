@@ -0,0 +1,241 @@
+////////////////////////////////////////////////////////////////////////////////
+// symbol_filter.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/symbol_filter.hpp"
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+// Symbols up to this long are packed into two words and perfect-hashed
+static const size_t PACKED_SYMBOL_BYTES = 16;
+
+// Displacements tried per bucket before the seed is changed
+static const uint32_t MAX_DISPLACEMENT = 1u << 16;
+
+struct PackedSymbol {
+    uint64_t lo;
+    uint64_t hi;
+};
+
+static PackedSymbol packSymbol(const char* symbol, size_t length) {
+    unsigned char bytes[PACKED_SYMBOL_BYTES] = {};
+    std::memcpy(bytes, symbol, length);
+    PackedSymbol key;
+    std::memcpy(&key.lo, bytes, 8);
+    std::memcpy(&key.hi, bytes + 8, 8);
+    return key;
+}
+
+static uint64_t hashSymbol(const PackedSymbol &key, size_t length, uint64_t seed) {
+    uint64_t h = (key.lo ^ seed) * 0x9E3779B97F4A7C15ull;
+    h ^= h >> 29;
+    h += key.hi * 0xC2B2AE3D27D4EB4Full + length;
+    h *= 0xBF58476D1CE4E5B9ull;
+    return h ^ (h >> 31);
+}
+
+static unsigned ceilLog2(size_t n) {
+    unsigned bits = 0;
+    while((size_t(1) << bits) < n) ++bits;
+    return bits;
+}
+
+/*
+ * Two-level perfect hash: the top bits of a symbol's hash pick a bucket,
+ * and the bucket's displacement, found at build time, moves all of its
+ * symbols to distinct free slots. A lookup is one hash, two loads and one
+ * compare.
+ */
+struct SymbolFilter::Table {
+    struct Slot {
+        PackedSymbol key;
+        uint32_t length; // 0 = empty
+    };
+
+    uint64_t seed = 0;
+    unsigned bucketBits = 1;
+    unsigned slotBits = 1;
+    std::vector<uint32_t> displacement;
+    std::vector<Slot> slots;
+    std::unordered_set<std::string> longSymbols; // Longer than PACKED_SYMBOL_BYTES
+
+    uint32_t bucketOf(uint64_t h) const { return static_cast<uint32_t>(h >> (64 - bucketBits)); }
+
+    uint32_t slotOf(uint64_t h, uint32_t d) const {
+        return static_cast<uint32_t>(((h ^ (d * 0x94D049BB133111EBull)) * 0x9E3779B97F4A7C15ull) >> (64 - slotBits));
+    }
+
+    bool contains(const char* symbol, size_t length) const {
+        if(length > PACKED_SYMBOL_BYTES) {
+            return !longSymbols.empty() && longSymbols.count(std::string(symbol, length)) != 0;
+        }
+        PackedSymbol key = packSymbol(symbol, length);
+        uint64_t h = hashSymbol(key, length, seed);
+        const Slot &slot = slots[slotOf(h, displacement[bucketOf(h)])];
+        return slot.length == length && slot.key.lo == key.lo && slot.key.hi == key.hi;
+    }
+
+    // Places every bucket with the current seed and sizes; false on a dead end
+    bool place(const std::vector<PackedSymbol> &keys, const std::vector<uint32_t> &lengths) {
+        std::vector<std::vector<size_t>> buckets(size_t(1) << bucketBits);
+        std::vector<uint64_t> hashes(keys.size());
+        for(size_t i = 0; i < keys.size(); ++i) {
+            hashes[i] = hashSymbol(keys[i], lengths[i], seed);
+            buckets[bucketOf(hashes[i])].push_back(i);
+        }
+        std::vector<uint32_t> order(buckets.size());
+        for(uint32_t b = 0; b < order.size(); ++b) order[b] = b;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        displacement.assign(buckets.size(), 0);
+        slots.assign(size_t(1) << slotBits, Slot{{0, 0}, 0});
+        std::vector<uint32_t> taken;
+        for(uint32_t b : order) {
+            const std::vector<size_t> &members = buckets[b];
+            if(members.empty()) break;
+            bool placed = false;
+            for(uint32_t d = 0; d < MAX_DISPLACEMENT && !placed; ++d) {
+                taken.clear();
+                placed = true;
+                for(size_t i : members) {
+                    uint32_t s = slotOf(hashes[i], d);
+                    if(slots[s].length != 0 || std::find(taken.begin(), taken.end(), s) != taken.end()) {
+                        placed = false;
+                        break;
+                    }
+                    taken.push_back(s);
+                }
+                if(placed) {
+                    displacement[b] = d;
+                    for(size_t j = 0; j < members.size(); ++j) {
+                        slots[taken[j]] = Slot{keys[members[j]], lengths[members[j]]};
+                    }
+                }
+            }
+            if(!placed) return false;
+        }
+        return true;
+    }
+};
+
+static std::shared_ptr<const SymbolFilter::Table> buildTable(const std::set<std::string> &symbols) {
+    auto table = std::make_shared<SymbolFilter::Table>();
+    std::vector<PackedSymbol> keys;
+    std::vector<uint32_t> lengths;
+    for(const std::string &s : symbols) {
+        if(s.empty()) continue;
+        if(s.size() > PACKED_SYMBOL_BYTES) {
+            table->longSymbols.insert(s);
+        } else {
+            keys.push_back(packSymbol(s.data(), s.size()));
+            lengths.push_back(static_cast<uint32_t>(s.size()));
+        }
+    }
+
+    // About two symbols per bucket and a load factor of at most one half
+    table->bucketBits = std::max(1u, ceilLog2(keys.size()) - (keys.size() > 2 ? 1 : 0));
+    table->slotBits = std::max(1u, ceilLog2(keys.size()) + 1);
+    for(uint64_t attempt = 0; !table->place(keys, lengths); ++attempt) {
+        table->seed = attempt + 1;
+        if(attempt % 8 == 7) table->slotBits++;
+    }
+    return table;
+}
+
+static std::atomic<uint64_t> nextFilterId{1};
+
+SymbolFilter::SymbolFilter()
+    : id(nextFilterId.fetch_add(1)), table(buildTable(members))
+{
+}
+
+SymbolFilter::~SymbolFilter()
+{
+}
+
+void SymbolFilter::assign(const std::vector<std::string> &symbols) {
+    std::lock_guard<std::mutex> lock(mutex);
+    members = std::set<std::string>(symbols.begin(), symbols.end());
+    rebuild();
+}
+
+void SymbolFilter::add(const std::string &symbol) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(members.insert(symbol).second) rebuild();
+}
+
+void SymbolFilter::remove(const std::string &symbol) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(members.erase(symbol) != 0) rebuild();
+}
+
+std::vector<std::string> SymbolFilter::symbols() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::vector<std::string>(members.begin(), members.end());
+}
+
+// Caller holds mutex
+void SymbolFilter::rebuild() {
+    table = buildTable(members);
+    version.fetch_add(1, std::memory_order_release);
+}
+
+bool SymbolFilter::contains(const char* symbol, size_t length) const {
+    if(length == 0) return false;
+
+    // Per-thread reference to the current table, refreshed only after a rebuild
+    struct ReaderCache {
+        uint64_t owner = 0;
+        uint64_t version = 0;
+        std::shared_ptr<const Table> table;
+    };
+    thread_local ReaderCache cache;
+    uint64_t current = version.load(std::memory_order_acquire);
+    if(cache.owner != id || cache.version != current || !cache.table) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.owner = id;
+        cache.version = version.load(std::memory_order_relaxed);
+        cache.table = table;
+    }
+    return cache.table->contains(symbol, length);
+}
+
+static inline bool isJsonSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool scanSymbolField(const char* data, size_t size, const char* &symbol, size_t &length) {
+    const char* end = data + size;
+    const char* open = static_cast<const char*>(std::memchr(data, '{', size));
+    if(open == nullptr) return false;
+
+    const char* p = open + 1;
+    while(p < end) {
+        const char* quote = static_cast<const char*>(std::memchr(p, '"', end - p));
+        if(quote == nullptr || end - quote < 3) return false;
+        p = quote + 1;
+        if(quote[1] != 's' || quote[2] != '"') continue;
+
+        // "s" : "value"
+        const char* v = quote + 3;
+        while(v < end && isJsonSpace(*v)) ++v;
+        if(v == end || *v != ':') continue;
+        ++v;
+        while(v < end && isJsonSpace(*v)) ++v;
+        if(v == end || *v != '"') return false;
+        ++v;
+        const char* close = static_cast<const char*>(std::memchr(v, '"', end - v));
+        if(close == nullptr || std::memchr(v, '\\', close - v) != nullptr) return false;
+
+        // A nested object or array before it could own this "s"
+        for(const char* c = open + 1; c < quote; ++c) {
+            if(*c == '{' || *c == '[') return false;
+        }
+        symbol = v;
+        length = static_cast<size_t>(close - v);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////////////////////////
+// thread_placement.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/thread_placement.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <utility>
+
+static const char* SYSFS_CPU_DIR = "/sys/devices/system/cpu";
+
+static bool readSysfsLine(const std::string &path, std::string &line) {
+    std::ifstream in(path);
+    return static_cast<bool>(std::getline(in, line));
+}
+
+static int readSysfsInt(const std::string &path, int fallback) {
+    std::string line;
+    if(!readSysfsLine(path, line)) return fallback;
+    try {
+        return std::stoi(line);
+    } catch(const std::exception &) {
+        return fallback;
+    }
+}
+
+bool parseCpuList(const std::string &text, std::vector<int> &cpus) {
+    cpus.clear();
+    std::stringstream ss(text);
+    std::string item;
+    while(std::getline(ss, item, ',')) {
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+        if(item.empty()) continue;
+        try {
+            size_t dash = item.find('-');
+            std::string firstText = item.substr(0, dash);
+            std::string lastText = dash == std::string::npos ? firstText : item.substr(dash + 1);
+            size_t firstLen = 0, lastLen = 0;
+            int first = std::stoi(firstText, &firstLen);
+            int last = std::stoi(lastText, &lastLen);
+            if(firstLen != firstText.size() || lastLen != lastText.size() || first < 0 || last < first) {
+                return false;
+            }
+            for(int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        } catch(const std::exception &) {
+            return false;
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return true;
+}
+
+std::vector<CpuInfo> readCpuTopology() {
+    std::vector<CpuInfo> topology;
+    std::string line;
+    std::vector<int> online;
+    if(!readSysfsLine(std::string(SYSFS_CPU_DIR) + "/online", line) || !parseCpuList(line, online)) {
+        return topology;
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    for(int cpu : online) {
+        if(cpu >= CPU_SETSIZE || (haveMask && !CPU_ISSET(cpu, &allowed))) continue;
+        std::string dir = std::string(SYSFS_CPU_DIR) + "/cpu" + std::to_string(cpu) + "/topology/";
+        CpuInfo info;
+        info.cpu = cpu;
+        info.package = readSysfsInt(dir + "physical_package_id", 0);
+        info.core = readSysfsInt(dir + "core_id", cpu);
+        topology.push_back(info);
+    }
+    return topology;
+}
+
+bool pinCurrentThread(const std::vector<int> &cpus) {
+    if(cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(int cpu : cpus) {
+        if(cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+void ThreadPlacement::plan(const std::vector<CpuInfo> &topology, const std::vector<int> &allowedCpus,
+                           int reserveCores, int monitors, bool dbWriter) {
+    active = false;
+    monitorCount = std::max(monitors, 0);
+    writerPlanned = dbWriter;
+    cpus.clear();
+    reserved.clear();
+    hot.clear();
+    for(const CpuInfo &c : topology) {
+        if(allowedCpus.empty() || std::binary_search(allowedCpus.begin(), allowedCpus.end(), c.cpu)) {
+            cpus.push_back(c);
+        }
+    }
+    if(cpus.empty()) return;
+
+    // Physical cores in order of their lowest CPU, each with its hyperthreads
+    std::vector<std::pair<std::pair<int, int>, std::vector<int>>> cores;
+    for(const CpuInfo &c : cpus) {
+        std::pair<int, int> key(c.package, c.core);
+        auto it = std::find_if(cores.begin(), cores.end(), [&](const auto &core) { return core.first == key; });
+        if(it == cores.end()) {
+            cores.push_back({key, {c.cpu}});
+        } else {
+            it->second.push_back(c.cpu);
+        }
+    }
+
+    // Always leave at least one core for the hot threads
+    size_t reservedCores = std::min<size_t>(static_cast<size_t>(std::max(reserveCores, 0)), cores.size() - 1);
+    for(size_t i = 0; i < reservedCores; ++i) {
+        reserved.insert(reserved.end(), cores[i].second.begin(), cores[i].second.end());
+    }
+    if(reserved.empty()) {
+        for(const CpuInfo &c : cpus) reserved.push_back(c.cpu);
+    }
+    std::sort(reserved.begin(), reserved.end());
+
+    // First hyperthread of every remaining core, then the second ones, ...
+    for(size_t sibling = 0; ; ++sibling) {
+        size_t added = 0;
+        for(size_t i = reservedCores; i < cores.size(); ++i) {
+            if(sibling < cores[i].second.size()) {
+                hot.push_back(cores[i].second[sibling]);
+                added++;
+            }
+        }
+        if(added == 0) break;
+    }
+    active = true;
+}
+
+int ThreadPlacement::hotCpu(ThreadRole role, int index) const {
+    if(hot.empty()) return -1;
+    size_t slot = role == ThreadRole::DbWriter ? static_cast<size_t>(monitorCount) : static_cast<size_t>(index);
+    return hot[slot % hot.size()];
+}
+
+const CpuInfo* ThreadPlacement::info(int cpu) const {
+    for(const CpuInfo &c : cpus) {
+        if(c.cpu == cpu) return &c;
+    }
+    return nullptr;
+}
+
+std::vector<int> ThreadPlacement::cpusFor(ThreadRole role, int index) const {
+    if(!active) return {};
+    if(role == ThreadRole::Main) return reserved;
+    return {hotCpu(role, index)};
+}
+
+void ThreadPlacement::pin(ThreadRole role, int index) const {
+    if(active) {
+        pinCurrentThread(cpusFor(role, index));
+    }
+}
+
+static std::string joinCpus(const std::vector<int> &cpus) {
+    std::string text;
+    for(int cpu : cpus) {
+        if(!text.empty()) text += ",";
+        text += std::to_string(cpu);
+    }
+    return text;
+}
+
+void ThreadPlacement::report(std::ostream &out) const {
+    if(!active) {
+        out << "placement: disabled, threads are not pinned" << std::endl;
+        return;
+    }
+    out << "placement: main and background threads -> cpus " << joinCpus(reserved) << std::endl;
+
+    // Hot threads this binary starts, in assignment order, flagging any that share a core
+    std::vector<std::pair<std::string, int>> assigned;
+    for(int i = 0; i < monitorCount + (writerPlanned ? 1 : 0); ++i) {
+        bool writer = i == monitorCount;
+        std::string name = writer ? "db-writer" : "monitor " + std::to_string(i);
+        int cpu = hotCpu(writer ? ThreadRole::DbWriter : ThreadRole::Monitor, i);
+        const CpuInfo* c = info(cpu);
+        out << "placement: " << name << " -> cpu " << cpu;
+        if(c) out << " (package " << c->package << " core " << c->core << ")";
+        for(const auto &prev : assigned) {
+            const CpuInfo* p = info(prev.second);
+            if(prev.second == cpu) {
+                out << ", shares the cpu with " << prev.first;
+                break;
+            }
+            if(c && p && c->package == p->package && c->core == p->core) {
+                out << ", hyperthread sibling of " << prev.first;
+                break;
+            }
+        }
+        if(std::binary_search(reserved.begin(), reserved.end(), cpu)) {
+            out << ", on a reserved cpu";
+        }
+        out << std::endl;
+        assigned.push_back({name, cpu});
+    }
+}
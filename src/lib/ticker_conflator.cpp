@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+// ticker_conflator.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/ticker_conflator.hpp"
+
+static std::atomic<uint64_t> nextConflatorId{1};
+
+TickerConflator::TickerConflator()
+    : id(nextConflatorId.fetch_add(1))
+{
+}
+
+TickerConflator::~TickerConflator()
+{
+}
+
+TickerConflator::Slot* TickerConflator::writerSlot() {
+    // Per-thread slot, claimed again after a reset()
+    struct WriterCache {
+        uint64_t owner = 0;
+        uint64_t generation = 0;
+        Slot* slot = nullptr;
+    };
+    thread_local WriterCache cache;
+    uint64_t current = generation.load(std::memory_order_acquire);
+    if(cache.owner == id && cache.generation == current && cache.slot) {
+        return cache.slot;
+    }
+
+    std::lock_guard<std::mutex> lock(slotsMutex);
+    Slot* slot = nullptr;
+    for(const auto &s : slots) {
+        if(!s->claimed) {
+            slot = s.get();
+            break;
+        }
+    }
+    if(!slot) {
+        slots.push_back(std::make_unique<Slot>());
+        slot = slots.back().get();
+    }
+    slot->claimed = true;
+    cache.owner = id;
+    cache.generation = generation.load(std::memory_order_relaxed);
+    cache.slot = slot;
+    return slot;
+}
+
+void TickerConflator::record(const std::string &symbol, double price) {
+    Slot* slot = writerSlot();
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    auto &map = slot->maps[slot->active];
+    auto it = map.find(symbol);
+    if(it == map.end()) {
+        it = map.emplace(symbol, TickerInterval()).first;
+    }
+    it->second.add(price);
+}
+
+void TickerConflator::reset() {
+    std::lock_guard<std::mutex> lock(slotsMutex);
+    for(const auto &slot : slots) {
+        std::lock_guard<std::mutex> slotLock(slot->mutex);
+        for(auto &map : slot->maps) {
+            for(auto &kv : map) kv.second.count = 0;
+        }
+        slot->claimed = false;
+    }
+    generation.fetch_add(1, std::memory_order_release);
+}
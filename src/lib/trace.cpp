@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////
+// trace.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/trace.hpp"
+
+#ifdef HF_ENABLE_TRACE
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Events kept per thread; older ones are overwritten
+static constexpr size_t kTraceCapacity = 1 << 16;
+
+struct TraceEvent {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> begin{0};
+    std::atomic<uint64_t> end{0};
+};
+
+/*
+ * Single-producer ring. Only the owning thread writes; the dumper reads
+ * with relaxed loads, so a zone being overwritten mid-dump may be torn
+ * but never blocks the producer.
+ */
+struct ThreadTraceBuffer {
+    int tid = 0;
+    std::string threadName;
+    std::atomic<uint64_t> head{0};
+    std::array<TraceEvent, kTraceCapacity> events;
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+    uint64_t epoch = readTicks();
+};
+
+static TraceRegistry& registry() {
+    static TraceRegistry instance;
+    return instance;
+}
+
+static ThreadTraceBuffer& localBuffer() {
+    // Buffers stay owned by the registry so zones of exited threads can still be dumped
+    thread_local ThreadTraceBuffer* buffer = [] {
+        auto buf = std::make_shared<ThreadTraceBuffer>();
+        TraceRegistry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        buf->tid = static_cast<int>(reg.buffers.size()) + 1;
+        buf->threadName = "thread-" + std::to_string(buf->tid);
+        reg.buffers.push_back(buf);
+        return buf.get();
+    }();
+    return *buffer;
+}
+
+static void writeJsonString(std::ostream &out, const std::string &s) {
+    out << '"';
+    for(char c : s) {
+        if(c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+void traceRecord(const char* name, uint64_t beginTicks, uint64_t endTicks) {
+    ThreadTraceBuffer &buf = localBuffer();
+    uint64_t h = buf.head.load(std::memory_order_relaxed);
+    TraceEvent &ev = buf.events[h & (kTraceCapacity - 1)];
+    ev.name.store(name, std::memory_order_relaxed);
+    ev.begin.store(beginTicks, std::memory_order_relaxed);
+    ev.end.store(endTicks, std::memory_order_relaxed);
+    buf.head.store(h + 1, std::memory_order_release);
+}
+
+void traceSetThreadName(const char* name) {
+    ThreadTraceBuffer &buf = localBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buf.threadName = name;
+}
+
+bool traceDumpChromeJson(const std::string &path) {
+    std::ofstream out(path);
+    if(!out.is_open()) {
+        return false;
+    }
+
+    TraceRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    const double perUs = ticksPerNanosecond() * 1000.0;
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for(const auto &buf : reg.buffers) {
+        // Thread name metadata
+        out << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+            << buf->tid << ",\"args\":{\"name\":";
+        writeJsonString(out, buf->threadName);
+        out << "}}";
+        first = false;
+
+        uint64_t head = buf->head.load(std::memory_order_acquire);
+        uint64_t start = head > kTraceCapacity ? head - kTraceCapacity : 0;
+        for(uint64_t i = start; i < head; ++i) {
+            const TraceEvent &ev = buf->events[i & (kTraceCapacity - 1)];
+            const char* name = ev.name.load(std::memory_order_relaxed);
+            uint64_t begin = ev.begin.load(std::memory_order_relaxed);
+            uint64_t end = ev.end.load(std::memory_order_relaxed);
+            if(name == nullptr || end < begin) continue;
+
+            out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid << ",\"name\":";
+            writeJsonString(out, name);
+            out << ",\"ts\":" << (static_cast<double>(begin) - static_cast<double>(reg.epoch)) / perUs
+                << ",\"dur\":" << (end - begin) / perUs << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+#endif // HF_ENABLE_TRACE
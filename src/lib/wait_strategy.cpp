@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+// wait_strategy.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "../include/wait_strategy.hpp"
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+const char* waitModeName(WaitMode mode) {
+    switch(mode) {
+        case WaitMode::Spin:      return "spin";
+        case WaitMode::SpinYield: return "spin_yield";
+        case WaitMode::Park:      return "park";
+        case WaitMode::Adaptive:  return "adaptive";
+    }
+    return "park";
+}
+
+bool parseWaitMode(const std::string &text, WaitMode &mode) {
+    for(WaitMode m : {WaitMode::Spin, WaitMode::SpinYield, WaitMode::Park, WaitMode::Adaptive}) {
+        if(text == waitModeName(m)) {
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+// std::atomic<uint32_t> is a plain 32-bit word on Linux, which is what the futex calls expect
+static uint32_t* futexWord(std::atomic<uint32_t> &word) {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a bare 32-bit word");
+    return reinterpret_cast<uint32_t*>(&word);
+}
+
+void WaitStrategy::sleepOn(uint32_t seen, std::chrono::nanoseconds timeout) {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(seconds.count());
+    ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+    // Returns at once if epoch moved since seen; EINTR and spurious wakeups are fine
+    syscall(SYS_futex, futexWord(epoch), FUTEX_WAIT_PRIVATE, seen, &ts, nullptr, 0);
+}
+
+void WaitStrategy::wake() {
+    syscall(SYS_futex, futexWord(epoch), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
@@ -10,15 +10,28 @@
 #include "include/stock_monitor.hpp"
 #include "include/dev_monitor.hpp"
 #include "include/advanced_graph_view.hpp"
+#include "include/book_view.hpp"
+#include "include/graph_renderer.hpp"
+#include "include/trace.hpp"
+#include "include/pipeline.hpp"
+#include "include/metrics_server.hpp"
+#include <cstdlib>
+#include <iostream>
 
 int main(int argc, char *argv[])
 {
     gtk_init(&argc, &argv);
+    HF_TRACE_THREAD_NAME("gtk-main");
 
     AppData app;
     app.config       = loadConfig("config.txt");
     app.dbClient     = std::make_shared<InfluxDBClient>(app.config.influxURL, app.config.influxDB);
     app.processor    = std::make_shared<DataProcessor>(app.dbClient, &app);
+    app.processor->latency.setEnabled(app.config.latencyRecording);
+    app.symbolFilter.assign(app.config.symbols);
+    app.symbolFilter.setEnabled(app.config.symbolFilter);
+    planThreadPlacement(&app, false); // Before any other thread starts; no batching writer here
+    registerPipelineMetrics(&app);
     app.stopFlag.store(false);
     app.requestCount.store(0);
     app.labelStats   = nullptr;
@@ -30,6 +43,7 @@ int main(int argc, char *argv[])
     app.xOffset      = 0.0;
     app.xScale       = 1.0;
     app.yScale       = 1.0;
+    app.barIntervalMs = app.config.barIntervals.front();
 
     // Main window
     GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
@@ -56,6 +70,12 @@ int main(int argc, char *argv[])
     g_signal_connect(toggleBtn, "clicked", G_CALLBACK(toggle_data_mode), &app);
     gtk_box_pack_start(GTK_BOX(controlBox), toggleBtn, FALSE, FALSE, 5);
 
+#ifdef HF_ENABLE_TRACE
+    GtkWidget *traceBtn = gtk_button_new_with_label("Dump Trace");
+    g_signal_connect(traceBtn, "clicked", G_CALLBACK(dump_trace), &app);
+    gtk_box_pack_start(GTK_BOX(controlBox), traceBtn, FALSE, FALSE, 5);
+#endif
+
     app.labelStats = gtk_label_new("Requests: 0 | Errors: 0");
     gtk_box_pack_start(GTK_BOX(controlBox), app.labelStats, FALSE, FALSE, 5);
 
@@ -66,7 +86,9 @@ int main(int argc, char *argv[])
     for(const auto& sym : app.config.symbols) {
         GtkWidget *chk = gtk_check_button_new_with_label(sym.c_str());
         gtk_widget_set_name(chk, sym.c_str());
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(chk), app.config.symbolFilter); // Subscribed at start
         g_signal_connect(chk, "toggled", G_CALLBACK(ticker_toggle_changed), &app);
+        app.symbolToggles[sym].push_back(GTK_TOGGLE_BUTTON(chk));
         gtk_box_pack_start(GTK_BOX(controlBox), chk, FALSE, FALSE, 5);
     }
 
@@ -78,6 +100,20 @@ int main(int argc, char *argv[])
     GtkWidget *graphTab = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
     gtk_notebook_append_page(GTK_NOTEBOOK(notebook), graphTab, gtk_label_new("Graph"));
 
+    // Line or candlestick chart, and the bar interval of the candles
+    GtkWidget *chartBox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    GtkWidget *candlesChk = gtk_check_button_new_with_label("Candles");
+    g_signal_connect(candlesChk, "toggled", G_CALLBACK(graph_candles_toggled), &app);
+    gtk_box_pack_start(GTK_BOX(chartBox), candlesChk, FALSE, FALSE, 5);
+    GtkWidget *intervalCombo = gtk_combo_box_text_new();
+    for(long long interval : app.config.barIntervals) {
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(intervalCombo), barIntervalName(interval).c_str());
+    }
+    gtk_combo_box_set_active(GTK_COMBO_BOX(intervalCombo), 0);
+    g_signal_connect(intervalCombo, "changed", G_CALLBACK(bar_interval_changed), &app);
+    gtk_box_pack_start(GTK_BOX(chartBox), intervalCombo, FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(graphTab), chartBox, FALSE, FALSE, 5);
+
     GtkWidget *drawArea = gtk_drawing_area_new();
     g_signal_connect(drawArea, "draw", G_CALLBACK(advanced_graph_on_draw), &app);
     g_signal_connect(drawArea, "scroll-event", G_CALLBACK(advanced_graph_scroll_event), &app);
@@ -93,7 +129,9 @@ int main(int argc, char *argv[])
         // Ticker visibility checkbox
         GtkWidget *chk = gtk_check_button_new_with_label(sym.c_str());
         gtk_widget_set_name(chk, sym.c_str()); // Set widget name for identification
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(chk), app.config.symbolFilter);
         g_signal_connect(chk, "toggled", G_CALLBACK(ticker_toggle_changed), &app);
+        app.symbolToggles[sym].push_back(GTK_TOGGLE_BUTTON(chk));
         gtk_box_pack_start(GTK_BOX(tickerBox), chk, FALSE, FALSE, 5);
         
         // Log-scale checkbox (initially inactive)
@@ -106,6 +144,8 @@ int main(int argc, char *argv[])
     }
     gtk_box_pack_start(GTK_BOX(graphTab), drawArea, TRUE, TRUE, 5);
     app.drawingArea = drawArea;
+    app.graphRenderer = std::make_shared<GraphRenderer>(drawArea);
+    app.graphRenderer->start();
 
     // Debug Tab
     GtkWidget *debugTab = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
@@ -124,23 +164,39 @@ int main(int argc, char *argv[])
     // Data Streams Tab
     setup_data_streams_tab(&app, notebook);
 
+    // Book Tab
+    setup_book_tab(&app, notebook);
+
+    // Latency Tab
+    setup_latency_tab(&app, notebook);
+
     gtk_widget_show_all(window);
 
     // Timers for UI, debug, and data streams updates
     g_timeout_add(1000/30, update_ui, &app);
     g_timeout_add(1000, update_debug_text, &app);
     g_timeout_add(1000, update_data_streams, &app);
+    g_timeout_add(1000, update_latency_view, &app);
+    g_timeout_add(BOOK_SAMPLE_MS, update_book_view, &app);
 
-    gtk_main();
+    // Prometheus endpoint (metrics_port in config.txt)
+    MetricsServer metricsServer;
+    if(app.config.metricsPort > 0) {
+        metricsServer.start(app.config.metricsBind, app.config.metricsPort);
+    }
 
-    // Cleanup
-    app.stopFlag.store(true);
-    for(auto &t : app.threads) {
-        if(t.joinable()) {
-            t.join();
-        }
+    gtk_main();
+    metricsServer.stop();
+    app.graphRenderer->stop();
+
+    // Cleanup: stop the monitors as the Stop button does, so the latency and
+    // trace dumps are written and the capture is closed
+    if(!stopMonitors(&app, app.config.shutdownTimeoutMs)) {
+        // Detached monitors still reference app; leave without running destructors
+        std::cerr << "Monitors still blocked on input after " << app.config.shutdownTimeoutMs
+                  << " ms; abandoning them" << std::endl;
+        std::_Exit(EXIT_SUCCESS);
     }
-    app.threads.clear();
 
     return 0;
 }
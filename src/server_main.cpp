@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// server_main.cpp
+///////////////////////////////////////////////////////////////////////////////
+// Headless ingest daemon: loads the config, starts the monitors right away,
+// writes to storage and reports stats through a metrics file. SIGTERM or
+// SIGINT (or the end of DEV input) drains the monitors and the storage
+// writer before exiting. No GTK objects are created.
+//
+//   hf_server [config.txt]
+///////////////////////////////////////////////////////////////////////////////
+#include "include/core_data.hpp"
+#include "include/config.hpp"
+#include "include/data_processor.hpp"
+#include "include/influx_db_client.hpp"
+#include "include/metrics_server.hpp"
+#include "include/pipeline.hpp"
+#include "include/trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+static volatile std::sig_atomic_t shutdownRequested = 0;
+
+static void onShutdownSignal(int) {
+    shutdownRequested = 1;
+}
+
+// Rewrites the metrics file atomically (write to .tmp, then rename)
+static void writeMetricsFile(CoreData &core, const std::string &path, double uptimeSeconds) {
+    if(path.empty()) return;
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        if(!out.is_open()) return;
+
+        out << "uptime_seconds " << uptimeSeconds << "\n";
+        out << "requests_total " << core.requestCount.load() << "\n";
+        out << "errors_total " << core.processor->errorCount.load() << "\n";
+        out << "filtered_total " << core.processor->filteredCount.load() << "\n";
+        out << "monitors_active " << core.activeMonitors.load() << "\n";
+        if(core.ingestQueue) {
+            out << "ingest_queue_depth " << core.ingestQueue->size() << "\n";
+            out << "ingest_queue_dropped " << core.ingestQueue->dropped.load() << "\n";
+        }
+        {
+            std::lock_guard<std::mutex> lock(core.statsMutex);
+            for(const auto &kv : core.dataStreamStats) {
+                out << "stream_messages{stream=\"" << kv.first << "\"} "
+                    << kv.second->messagesReceived.load() << "\n";
+                out << "stream_errors{stream=\"" << kv.first << "\"} "
+                    << kv.second->errors.load() << "\n";
+            }
+        }
+
+        InfluxDBClient &db = *core.dbClient;
+        out << "db_lines_queued " << db.linesQueued.load() << "\n";
+        out << "db_lines_flushed " << db.linesFlushed.load() << "\n";
+        out << "db_bytes_flushed " << db.bytesFlushed.load() << "\n";
+        out << "db_batches_flushed " << db.batchesFlushed.load() << "\n";
+        out << "db_flush_failures " << db.flushFailures.load() << "\n";
+        out << "db_lines_dropped " << db.linesDropped.load() << "\n";
+        out << "book_orders " << core.book.liveOrders.load() << "\n";
+        out << "book_unmatched " << core.book.unmatched.load() << "\n";
+
+        for(const auto &s : core.processor->latency.summarize()) {
+            const char* stage = latencyStageName(s.stage);
+            out << "latency_ns{stage=\"" << stage << "\",quantile=\"0.5\"} " << s.p50 << "\n";
+            out << "latency_ns{stage=\"" << stage << "\",quantile=\"0.99\"} " << s.p99 << "\n";
+            out << "latency_ns{stage=\"" << stage << "\",quantile=\"0.999\"} " << s.p999 << "\n";
+            out << "latency_ns_max{stage=\"" << stage << "\"} " << s.max << "\n";
+            out << "latency_count{stage=\"" << stage << "\"} " << s.count << "\n";
+        }
+    }
+    std::rename(tmpPath.c_str(), path.c_str());
+}
+
+int main(int argc, char *argv[])
+{
+    std::string configPath = argc > 1 ? argv[1] : "config.txt";
+    HF_TRACE_THREAD_NAME("server-main");
+
+    CoreData core;
+    core.config    = loadConfig(configPath);
+    core.dbClient  = std::make_shared<InfluxDBClient>(core.config.influxURL, core.config.influxDB);
+    core.processor = std::make_shared<DataProcessor>(core.dbClient, &core);
+    core.processor->latency.setEnabled(core.config.latencyRecording);
+    core.symbolFilter.assign(core.config.symbols);
+    core.symbolFilter.setEnabled(core.config.symbolFilter);
+    planThreadPlacement(&core, true); // Before any other thread starts
+
+    // Storage writes go through the batching writer thread
+    core.dbClient->setPendingLimit(static_cast<size_t>(std::max(core.config.influxMaxPendingBytes, 0)),
+                                   core.config.influxOverflow);
+    core.dbClient->startBatching(core.config.influxHttp,
+                                 static_cast<size_t>(core.config.influxBatchBytes),
+                                 core.config.influxFlushMs,
+                                 core.config.dbWriterWait,
+                                 core.placement.cpusFor(ThreadRole::DbWriter));
+
+    // Prometheus endpoint; declared after core so it stops before core is destroyed
+    registerPipelineMetrics(&core);
+    MetricsServer metricsServer;
+    if(core.config.metricsPort > 0) {
+        metricsServer.start(core.config.metricsBind, core.config.metricsPort);
+    }
+
+    struct sigaction sa = {};
+    sa.sa_handler = onShutdownSignal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, nullptr);
+    sigaction(SIGINT, &sa, nullptr);
+
+    auto startTime = std::chrono::steady_clock::now();
+    if(!startMonitors(&core)) {
+        std::cerr << "hf_server: no monitors started (check total_cores/reserve_cores or replay_file)" << std::endl;
+        metricsServer.stop();
+        core.dbClient->stopBatching();
+        return 1;
+    }
+    std::cerr << "hf_server: " << core.activeMonitors.load() << " monitors started in "
+              << dataModeName(core.config.dataMode) << " mode" << std::endl;
+
+    // Report stats until asked to stop or until every monitor ran out of input
+    const auto interval = std::chrono::milliseconds(core.config.metricsIntervalMs > 0 ? core.config.metricsIntervalMs : 1000);
+    auto nextReport = startTime + interval;
+    while(!shutdownRequested && core.activeMonitors.load() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        auto now = std::chrono::steady_clock::now();
+        if(now >= nextReport) {
+            writeMetricsFile(core, core.config.metricsFile,
+                             std::chrono::duration<double>(now - startTime).count());
+            nextReport = now + interval;
+        }
+    }
+
+    // Drain: stop the monitors, then flush everything pending to storage
+    bool joined = stopMonitors(&core, core.config.shutdownTimeoutMs);
+    if(!joined) {
+        std::cerr << "hf_server: monitors still blocked on input after "
+                  << core.config.shutdownTimeoutMs << " ms; abandoning them" << std::endl;
+    }
+    core.dbClient->stopBatching();
+    writeMetricsFile(core, core.config.metricsFile,
+                     std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+    std::cerr << "hf_server: stopped after " << core.requestCount.load() << " requests, "
+              << core.dbClient->linesFlushed.load() << " lines written" << std::endl;
+
+    if(!joined) {
+        // Detached monitors still reference core; leave without running destructors
+        metricsServer.stop();
+        std::cout.flush();
+        std::_Exit(EXIT_SUCCESS);
+    }
+    return 0;
+}
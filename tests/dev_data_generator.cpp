@@ -1,12 +1,17 @@
 #include <iostream>
 #include <string>
-#include <random>
+#include <vector>
+#include <atomic>
 #include <chrono>
-#include <thread>
-#include <nlohmann/json.hpp>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <mutex>
-
-using json = nlohmann::json;
+#include <thread>
+#include <cerrno>
+#include <unistd.h>
+#include "order_flow_generator.hpp"
 
 // Function to get current time in milliseconds since epoch
 long long current_timestamp_ms() {
@@ -15,72 +20,360 @@ long long current_timestamp_ms() {
         .count();
 }
 
-int main(int argc, char* argv[]) {
-    std::vector<std::string> symbols = {"AAPL", "GOOG", "MSFT"};
-    int messages_per_second = 10; // Adjust as needed
-    int duration_seconds = 60;    // Duration to run
-
-    std::random_device rd;
-    std::mt19937 rng(rd());
-    std::uniform_int_distribution<int> dist_type(0, 3);
-    std::uniform_int_distribution<int> dist_qty(1, 1000);
-    std::uniform_real_distribution<double> dist_price(100.0, 500.0);
-    std::uniform_int_distribution<int> dist_side(0, 1);
-    std::uniform_int_distribution<int> dist_broker(0, 3);
-    std::uniform_int_distribution<int> dist_id(10000, 99999);
-
-    std::vector<std::string> message_types = {"oba", "obf", "obc", "obr"};
-    std::vector<std::string> sides = {"buy", "sell"};
-    std::vector<std::string> brokers = {"BrokerA", "BrokerB", "BrokerC", "BrokerD"};
-
-    auto start_time = std::chrono::steady_clock::now();
-    auto end_time = start_time + std::chrono::seconds(duration_seconds);
-    double interval_ms = 1000.0 / messages_per_second;
-
-    while (std::chrono::steady_clock::now() < end_time) {
-        auto msg_start = std::chrono::steady_clock::now();
-
-        // Construct JSON object
-        json j;
-        try {
-            j["type"] = message_types[dist_type(rng)];
-            j["s"] = symbols[dist_type(rng) % symbols.size()];
-            j["tm"] = current_timestamp_ms();
-            j["q"] = dist_qty(rng);
-            j["p"] = std::round(dist_price(rng) * 100.0) / 100.0; // Ensure consistent formatting
-            j["x"] = sides[dist_side(rng)];
-            j["id"] = "ID" + std::to_string(dist_id(rng));
-            j["a"] = brokers[dist_broker(rng)];
-            j["mid"] = "MID" + std::to_string(dist_id(rng));
-            if (j["type"] == "obr") {
-                j["nid"] = "NID" + std::to_string(dist_id(rng));
-            }
+static void usage(const char* argv0) {
+    std::cerr
+        << "usage: " << argv0 << " [options]\n"
+        << "  --symbols N        number of symbols (default 3)\n"
+        << "  --zipf S           Zipf exponent for symbol popularity, 0 = uniform (default 1.0)\n"
+        << "  --rate R           mean messages per second (default 10)\n"
+        << "  --no-pace          emit as fast as possible, timestamps stay simulated\n"
+        << "  --burst F          rate multiplier during bursts, 1 = no bursts (default 1)\n"
+        << "  --burst-len S      mean burst length in seconds (default 0.1)\n"
+        << "  --burst-gap S      mean seconds between bursts (default 2)\n"
+        << "  --max-orders N     live orders per symbol before cancels dominate (default 2000)\n"
+        << "  --duration S       stop after S simulated seconds, 0 = no limit (default 60)\n"
+        << "  --count N          stop after N messages, 0 = no limit (default 0)\n"
+        << "  --seed N           random seed (default 1)\n"
+        << "  --start-ms MS      timestamp of the first message (default: now)\n"
+        << "  --fast             high-rate mode: token-bucket pacing at a constant --rate,\n"
+        << "                     batched writes and a rate report on stderr\n"
+        << "  --threads N        generator threads in --fast mode (default 1)\n";
+}
+
+// Classic tickers first, then SYM000, SYM001, ...
+static std::vector<std::string> makeSymbols(size_t count) {
+    static const char* known[] = {"AAPL", "GOOG", "MSFT", "AMZN", "NVDA", "META", "TSLA", "NFLX"};
+    std::vector<std::string> symbols;
+    for(size_t i = 0; i < count; ++i) {
+        if(i < sizeof(known) / sizeof(known[0])) {
+            symbols.push_back(known[i]);
+        } else {
+            char name[24];
+            std::snprintf(name, sizeof(name), "SYM%03zu", i);
+            symbols.push_back(name);
+        }
+    }
+    return symbols;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Output
+////////////////////////////////////////////////////////////////////////////////
+
+// Longest line formatLine can produce, including the newline
+static constexpr size_t MAX_LINE_BYTES = 256;
+
+static const char* brokers[] = {"BrokerA", "BrokerB", "BrokerC", "BrokerD"};
+
+static char* appendText(char* p, const char* text, size_t len) {
+    std::memcpy(p, text, len);
+    return p + len;
+}
+
+template <size_t N>
+static char* appendLiteral(char* p, const char (&text)[N]) {
+    return appendText(p, text, N - 1);
+}
+
+static char* appendInt(char* p, long long value) {
+    return std::to_chars(p, p + 24, value).ptr;
+}
+
+// Cents as a fixed two-decimal price, e.g. 10005 -> 100.05
+static char* appendPrice(char* p, long long ticks) {
+    p = appendInt(p, ticks / 100);
+    int cents = static_cast<int>(ticks % 100);
+    *p++ = '.';
+    *p++ = static_cast<char>('0' + cents / 10);
+    *p++ = static_cast<char>('0' + cents % 10);
+    return p;
+}
+
+// Renders one message as a JSON line without building a JSON object
+static char* formatLine(char* p, const OrderEvent &ev, const std::string &symbol) {
+    p = appendLiteral(p, "{\"type\":\"");
+    p = appendText(p, orderEventTag(ev.type), 3);
+    p = appendLiteral(p, "\",\"s\":\"");
+    p = appendText(p, symbol.data(), symbol.size());
+    p = appendLiteral(p, "\",\"tm\":");
+    p = appendInt(p, ev.timestampMs);
+    p = appendLiteral(p, ",\"q\":");
+    p = appendInt(p, ev.quantity);
+    p = appendLiteral(p, ",\"p\":");
+    p = appendPrice(p, ev.priceTicks);
+    p = ev.buy ? appendLiteral(p, ",\"x\":\"buy\",\"id\":\"ID") : appendLiteral(p, ",\"x\":\"sell\",\"id\":\"ID");
+    p = appendInt(p, static_cast<long long>(ev.orderID));
+    p = appendLiteral(p, "\",\"a\":\"");
+    p = appendText(p, brokers[ev.broker], 7);
+    p = appendLiteral(p, "\",\"mid\":\"");
+    if(ev.type == OrderEventType::Fill) {
+        p = appendLiteral(p, "MID");
+        p = appendInt(p, static_cast<long long>(ev.matchID));
+    }
+    if(ev.type == OrderEventType::Replace) {
+        p = appendLiteral(p, "\",\"nid\":\"ID");
+        p = appendInt(p, static_cast<long long>(ev.newID));
+    }
+    return appendLiteral(p, "\"}\n");
+}
+
+static std::mutex outputMutex;
+
+// Whole buffers go out under one lock so lines from different threads never interleave
+static bool writeAll(const char* data, size_t len) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    while(len > 0) {
+        ssize_t n = ::write(STDOUT_FILENO, data, len);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Pacing
+////////////////////////////////////////////////////////////////////////////////
+
+using Clock = std::chrono::steady_clock;
+
+// Sleeps for most of the wait and spins the last stretch; sleep_for alone overshoots by ~50-100us
+static void waitUntil(Clock::time_point deadline) {
+    const auto spinWindow = std::chrono::microseconds(200);
+    auto now = Clock::now();
+    if(deadline - now > spinWindow) {
+        std::this_thread::sleep_for(deadline - now - spinWindow);
+    }
+    while(Clock::now() < deadline) {
+    }
+}
+
+/*
+ * Token bucket: tokens accrue at `rate` per second up to `capacity`, and
+ * take(n) blocks until n are available. A capacity of a couple of batches
+ * absorbs scheduler hiccups without letting a long stall turn into a burst.
+ */
+class TokenBucket {
+public:
+    TokenBucket(double rate, double capacity)
+        : rate(rate), capacity(capacity), tokens(0.0), last(Clock::now()) {}
+
+    void take(double n) {
+        refill();
+        if(tokens < n) {
+            auto wait = std::chrono::duration<double>((n - tokens) / rate);
+            waitUntil(last + std::chrono::duration_cast<Clock::duration>(wait));
+            refill();
+        }
+        tokens -= n;
+    }
+
+private:
+    void refill() {
+        auto now = Clock::now();
+        tokens = std::min(capacity, tokens + std::chrono::duration<double>(now - last).count() * rate);
+        last = now;
+    }
+
+    double rate;
+    double capacity;
+    double tokens;
+    Clock::time_point last;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Generator loops
+////////////////////////////////////////////////////////////////////////////////
+
+struct RunLimits {
+    double durationSeconds;
+    unsigned long long maxMessages; // 0 = no limit
+    bool paced;
+};
+
+static std::atomic<unsigned long long> messagesWritten{0};
+static std::atomic<unsigned long long> bytesWritten{0};
+
+/*
+ * Default mode: every message is released at its simulated time, so bursts
+ * show up on the wire. Lines due at the same moment are coalesced into one
+ * write, which is flushed before every wait.
+ */
+static void runScheduled(const OrderFlowOptions &options, const RunLimits &limits) {
+    OrderFlowGenerator generator(options);
+    std::vector<char> buffer(1 << 16);
+    size_t used = 0;
+    auto start = Clock::now();
+
+    for(unsigned long long sent = 0; limits.maxMessages == 0 || sent < limits.maxMessages; ++sent) {
+        OrderEvent ev = generator.next();
+        if(limits.durationSeconds > 0.0 && ev.simSeconds >= limits.durationSeconds) {
+            break;
+        }
 
-            // Serialize to JSON string
-            std::string jsonString = j.dump();
+        auto due = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(ev.simSeconds));
+        if(used > 0 && (used + MAX_LINE_BYTES > buffer.size() || (limits.paced && Clock::now() < due))) {
+            if(!writeAll(buffer.data(), used)) return;
+            used = 0;
+        }
+        if(limits.paced) {
+            waitUntil(due);
+        }
+        used = static_cast<size_t>(formatLine(buffer.data() + used, ev, options.symbols[ev.symbol]) - buffer.data());
+    }
+    if(used > 0) {
+        writeAll(buffer.data(), used);
+    }
+}
 
-            // Validate JSON by parsing back into an object
-            json::parse(jsonString);  // If this throws, the JSON is invalid
+/*
+ * High-rate mode: each thread pre-renders a batch sized to ~1 ms of its
+ * share of the traffic into a 1 MiB buffer, takes that many tokens and
+ * writes the batch with one write() call.
+ */
+static void runFast(OrderFlowOptions options, RunLimits limits) {
+    OrderFlowGenerator generator(options);
+    const size_t bufferBytes = 1 << 20;
+    const size_t maxBatch = bufferBytes / MAX_LINE_BYTES;
+    size_t batch = static_cast<size_t>(options.rate / 1000.0);
+    batch = std::max<size_t>(1, std::min(batch, maxBatch));
 
-            // Thread-safe output
-            static std::mutex cout_mutex;
-            {
-                std::lock_guard<std::mutex> lock(cout_mutex);
-                std::cout << jsonString << std::endl;
+    std::vector<char> buffer(bufferBytes);
+    TokenBucket bucket(options.rate, 2.0 * static_cast<double>(batch));
+    unsigned long long sent = 0;
+    bool done = false;
+
+    while(!done) {
+        char* p = buffer.data();
+        size_t count = 0;
+        while(count < batch) {
+            if(limits.maxMessages != 0 && sent == limits.maxMessages) {
+                done = true;
+                break;
+            }
+            OrderEvent ev = generator.next();
+            if(limits.durationSeconds > 0.0 && ev.simSeconds >= limits.durationSeconds) {
+                done = true;
+                break;
             }
-        } catch (const json::exception& e) {
-            // Log and skip invalid JSON
-            std::cerr << "JSON generation error: " << e.what() << std::endl;
-            continue;
+            p = formatLine(p, ev, options.symbols[ev.symbol]);
+            ++count;
+            ++sent;
         }
+        if(count == 0) break;
 
-        auto msg_end = std::chrono::steady_clock::now();
-        std::chrono::duration<double, std::milli> elapsed = msg_end - msg_start;
-        double sleep_time = interval_ms - elapsed.count();
-        if (sleep_time > 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(sleep_time)));
+        if(limits.paced) {
+            bucket.take(static_cast<double>(count));
         }
+        size_t len = static_cast<size_t>(p - buffer.data());
+        if(!writeAll(buffer.data(), len)) return;
+        messagesWritten.fetch_add(count, std::memory_order_relaxed);
+        bytesWritten.fetch_add(len, std::memory_order_relaxed);
     }
+}
+
+static void reportRate(const char* label, unsigned long long messages, unsigned long long bytes, double seconds) {
+    std::fprintf(stderr, "data_gen: %s %llu msgs in %.3f s = %.0f msg/s, %.1f MB/s\n",
+                 label, messages, seconds, seconds > 0.0 ? messages / seconds : 0.0,
+                 seconds > 0.0 ? bytes / seconds / 1e6 : 0.0);
+}
 
+int main(int argc, char* argv[]) {
+    OrderFlowOptions options;
+    size_t symbolCount = 3;
+    RunLimits limits{60.0, 0, true};
+    bool startSet = false;
+    bool fast = false;
+    unsigned threadCount = 1;
+
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(arg == "--symbols" && hasValue) symbolCount = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--zipf" && hasValue) options.zipfExponent = std::atof(argv[++i]);
+        else if(arg == "--rate" && hasValue) options.rate = std::atof(argv[++i]);
+        else if(arg == "--no-pace") limits.paced = false;
+        else if(arg == "--burst" && hasValue) options.burstFactor = std::atof(argv[++i]);
+        else if(arg == "--burst-len" && hasValue) options.burstSeconds = std::atof(argv[++i]);
+        else if(arg == "--burst-gap" && hasValue) options.burstGapSeconds = std::atof(argv[++i]);
+        else if(arg == "--max-orders" && hasValue) options.maxOrdersPerSymbol = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--duration" && hasValue) limits.durationSeconds = std::atof(argv[++i]);
+        else if(arg == "--count" && hasValue) limits.maxMessages = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--seed" && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--start-ms" && hasValue) { options.startMs = std::atoll(argv[++i]); startSet = true; }
+        else if(arg == "--fast") fast = true;
+        else if(arg == "--threads" && hasValue) threadCount = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else { usage(argv[0]); return arg == "--help" ? 0 : 1; }
+    }
+
+    if(symbolCount == 0 || options.rate <= 0.0 || options.burstSeconds <= 0.0 ||
+       options.burstGapSeconds <= 0.0 || options.maxOrdersPerSymbol < 20 ||
+       threadCount == 0 || (threadCount > 1 && !fast)) {
+        usage(argv[0]);
+        return 1;
+    }
+    options.symbols = makeSymbols(symbolCount);
+    if(!startSet) {
+        options.startMs = current_timestamp_ms();
+    }
+
+    if(!fast) {
+        // Output bytes depend only on the options, seed and --start-ms
+        runScheduled(options, limits);
+        return 0;
+    }
+
+    // Bursts would fight the constant-rate bucket, so fast mode runs without them
+    options.burstFactor = 1.0;
+
+    // Each thread owns a generator with its own seed, id range and share of the rate
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for(unsigned t = 0; t < threadCount; ++t) {
+        OrderFlowOptions threadOptions = options;
+        threadOptions.seed = options.seed + t;
+        threadOptions.firstID = 1 + (static_cast<uint64_t>(t) << 48);
+        threadOptions.rate = options.rate / threadCount;
+
+        RunLimits threadLimits = limits;
+        if(limits.maxMessages != 0) {
+            threadLimits.maxMessages = limits.maxMessages / threadCount + (t < limits.maxMessages % threadCount ? 1 : 0);
+            if(threadLimits.maxMessages == 0) continue;
+        }
+        workers.emplace_back(runFast, threadOptions, threadLimits);
+    }
+
+    // Progress once per second while the workers run
+    std::atomic<bool> finished{false};
+    std::thread reporter([&] {
+        auto lastTime = start;
+        unsigned long long lastMessages = 0, lastBytes = 0;
+        while(!finished.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            auto now = Clock::now();
+            if(now - lastTime < std::chrono::seconds(1)) continue;
+            unsigned long long m = messagesWritten.load(), b = bytesWritten.load();
+            reportRate("interval", m - lastMessages, b - lastBytes,
+                       std::chrono::duration<double>(now - lastTime).count());
+            lastTime = now;
+            lastMessages = m;
+            lastBytes = b;
+        }
+    });
+
+    for(auto &w : workers) {
+        w.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    finished = true;
+    reporter.join();
+
+    reportRate("total", messagesWritten.load(), bytesWritten.load(), elapsed);
+    if(limits.paced) {
+        std::fprintf(stderr, "data_gen: target %.0f msg/s over %u thread(s)\n", options.rate, threadCount);
+    }
     return 0;
 }
@@ -0,0 +1,253 @@
+////////////////////////////////////////////////////////////////////////////////
+// tests/order_flow_generator.hpp
+//////////////////////////////////////////////////////////////////////////////
+#ifndef ORDER_FLOW_GENERATOR_HPP
+#define ORDER_FLOW_GENERATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Synthetic market-by-order flow with consistent order lifecycles.
+ *
+ * Every symbol keeps its own book of live orders around a random-walk mid
+ * price. Adds (oba) create orders, replaces (obr) move a live order to a
+ * new price/size under a new id (nid), fills (obf) and cancels (obc)
+ * consume live orders, so every id refers to an order that exists.
+ * Symbols are drawn with Zipf popularity and inter-arrival times follow a
+ * Poisson process whose rate jumps by burstFactor during bursts. All
+ * randomness comes from one seeded engine, so the same options and seed
+ * always produce the same event sequence.
+ */
+
+struct OrderFlowOptions {
+    std::vector<std::string> symbols;
+    double zipfExponent = 1.0;   // 0 = uniform popularity
+    double rate = 10.0;          // mean messages per second outside bursts
+    double burstFactor = 1.0;    // rate multiplier while bursting (1 = no bursts)
+    double burstSeconds = 0.1;   // mean burst length
+    double burstGapSeconds = 2.0;// mean time between bursts
+    size_t maxOrdersPerSymbol = 2000;
+    uint64_t seed = 1;
+    long long startMs = 0;       // timestamp of the first event
+    uint64_t firstID = 1;        // first order/match id, keeps parallel generators disjoint
+};
+
+enum class OrderEventType {
+    Add,     // oba
+    Replace, // obr
+    Fill,    // obf
+    Cancel   // obc
+};
+
+struct OrderEvent {
+    OrderEventType type;
+    size_t symbol;        // index into OrderFlowOptions::symbols
+    long long timestampMs;
+    double simSeconds;    // simulated time since the first event
+    int quantity;
+    long long priceTicks; // price in cents
+    bool buy;
+    uint64_t orderID;
+    uint64_t newID;       // Replace only
+    uint64_t matchID;     // Fill only
+    int broker;
+};
+
+inline const char* orderEventTag(OrderEventType type) {
+    switch(type) {
+        case OrderEventType::Add:     return "oba";
+        case OrderEventType::Replace: return "obr";
+        case OrderEventType::Fill:    return "obf";
+        default:                      return "obc";
+    }
+}
+
+class OrderFlowGenerator {
+public:
+    static constexpr int BROKER_COUNT = 4;
+
+    explicit OrderFlowGenerator(const OrderFlowOptions &opts)
+        : options(opts), rng(opts.seed), books(opts.symbols.size()),
+          nextOrderID(opts.firstID), nextMatchID(opts.firstID)
+    {
+        std::vector<double> weights;
+        for(size_t i = 0; i < options.symbols.size(); ++i) {
+            weights.push_back(1.0 / std::pow(static_cast<double>(i + 1), options.zipfExponent));
+            // Spread starting mids so symbols are distinguishable on a chart
+            books[i].midTicks = 10000 + 2500 * static_cast<long long>(i % 40);
+        }
+        symbolDist = std::discrete_distribution<size_t>(weights.begin(), weights.end());
+        bursting = false;
+        stateEnds = drawExponential(1.0 / options.burstGapSeconds);
+    }
+
+    // Produces the next event and advances simulated time
+    OrderEvent next() {
+        advanceClock();
+
+        OrderEvent ev{};
+        ev.symbol = symbolDist(rng);
+        ev.simSeconds = simTime;
+        ev.timestampMs = options.startMs + static_cast<long long>(simTime * 1000.0);
+        ev.broker = static_cast<int>(rng() % BROKER_COUNT);
+
+        SymbolBook &book = books[ev.symbol];
+        stepMid(book);
+
+        // Keep books populated but bounded: mostly add when thin, mostly cancel when full
+        int roll = static_cast<int>(rng() % 100);
+        if(book.live.size() < 20) roll = 0;
+        else if(book.live.size() >= options.maxOrdersPerSymbol) roll = 99;
+
+        if(roll < 45) {
+            addOrder(book, ev);
+        } else if(roll < 65) {
+            replaceOrder(book, ev);
+        } else if(roll < 80) {
+            fillOrder(book, ev);
+        } else {
+            cancelOrder(book, ev);
+        }
+        return ev;
+    }
+
+    double simulatedSeconds() const { return simTime; }
+
+private:
+    struct Order {
+        uint64_t id;
+        long long priceTicks;
+        int quantity;
+        bool buy;
+    };
+
+    struct SymbolBook {
+        long long midTicks = 10000;
+        std::vector<Order> live;
+    };
+
+    OrderFlowOptions options;
+    std::mt19937_64 rng;
+    std::vector<SymbolBook> books;
+    std::discrete_distribution<size_t> symbolDist;
+    uint64_t nextOrderID;
+    uint64_t nextMatchID;
+    double simTime = 0.0;
+    bool bursting;
+    double stateEnds;
+
+    double uniform() {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    }
+
+    double drawExponential(double lambda) {
+        return std::exponential_distribution<double>(lambda)(rng);
+    }
+
+    void advanceClock() {
+        if(options.rate <= 0.0) return;
+        double rate = bursting ? options.rate * options.burstFactor : options.rate;
+        simTime += drawExponential(rate);
+        if(options.burstFactor > 1.0) {
+            while(simTime >= stateEnds) {
+                bursting = !bursting;
+                stateEnds += drawExponential(1.0 / (bursting ? options.burstSeconds : options.burstGapSeconds));
+            }
+        }
+    }
+
+    void stepMid(SymbolBook &book) {
+        // +-1 tick random walk, kept positive
+        int step = static_cast<int>(rng() % 3) - 1;
+        book.midTicks = std::max(100LL, book.midTicks + step);
+    }
+
+    // Live orders are kept dense so a random pick and a removal are both O(1)
+    size_t pickLive(SymbolBook &book) {
+        return static_cast<size_t>(rng() % book.live.size());
+    }
+
+    void eraseOrder(SymbolBook &book, size_t pos) {
+        book.live[pos] = book.live.back();
+        book.live.pop_back();
+    }
+
+    long long quotePrice(const SymbolBook &book, bool buy) {
+        // Resting orders cluster near the mid: geometric distance in ticks
+        long long offset = std::geometric_distribution<int>(0.3)(rng);
+        long long price = buy ? book.midTicks - 1 - offset : book.midTicks + 1 + offset;
+        return std::max(1LL, price);
+    }
+
+    int drawQuantity() {
+        // Round lots most of the time, odd lots otherwise
+        if(uniform() < 0.7) return 100 * (1 + static_cast<int>(rng() % 10));
+        return 1 + static_cast<int>(rng() % 99);
+    }
+
+    void addOrder(SymbolBook &book, OrderEvent &ev) {
+        Order order;
+        order.buy = (rng() & 1) != 0;
+        order.priceTicks = quotePrice(book, order.buy);
+        order.quantity = drawQuantity();
+
+        ev.type = OrderEventType::Add;
+        ev.orderID = nextOrderID++;
+        ev.buy = order.buy;
+        ev.priceTicks = order.priceTicks;
+        ev.quantity = order.quantity;
+        order.id = ev.orderID;
+        book.live.push_back(order);
+    }
+
+    void replaceOrder(SymbolBook &book, OrderEvent &ev) {
+        Order &order = book.live[pickLive(book)];
+        order.priceTicks = quotePrice(book, order.buy);
+        order.quantity = drawQuantity();
+
+        ev.type = OrderEventType::Replace;
+        ev.orderID = order.id;
+        ev.newID = nextOrderID++;
+        ev.buy = order.buy;
+        ev.priceTicks = order.priceTicks;
+        ev.quantity = order.quantity;
+        order.id = ev.newID;
+    }
+
+    void fillOrder(SymbolBook &book, OrderEvent &ev) {
+        size_t pos = pickLive(book);
+        Order &order = book.live[pos];
+        int filled = 1 + static_cast<int>(rng() % order.quantity);
+
+        ev.type = OrderEventType::Fill;
+        ev.orderID = order.id;
+        ev.matchID = nextMatchID++;
+        ev.buy = order.buy;
+        ev.priceTicks = order.priceTicks;
+        ev.quantity = filled;
+
+        order.quantity -= filled;
+        if(order.quantity == 0) {
+            eraseOrder(book, pos);
+        }
+    }
+
+    void cancelOrder(SymbolBook &book, OrderEvent &ev) {
+        size_t pos = pickLive(book);
+        const Order &order = book.live[pos];
+
+        ev.type = OrderEventType::Cancel;
+        ev.orderID = order.id;
+        ev.buy = order.buy;
+        ev.priceTicks = order.priceTicks;
+        ev.quantity = order.quantity;
+        eraseOrder(book, pos);
+    }
+};
+
+#endif // ORDER_FLOW_GENERATOR_HPP